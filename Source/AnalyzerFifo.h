@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Single producer, single consumer sample FIFO carrying a mono mix of the
+    audio from processBlock to the spectrum analyzer. Writing is wait free
+    and never allocates; when the reader falls behind, samples are dropped.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class AnalyzerFifo
+{
+public:
+	static constexpr int capacity = 1 << 15; //more than a frame's worth even at 192 kHz
+
+	AnalyzerFifo() : storage(capacity, 0.f) {}
+
+	//audio thread
+	void push(const juce::AudioBuffer<float>& buffer) noexcept
+	{
+		int start1, size1, start2, size2;
+		fifo.prepareToWrite(buffer.getNumSamples(), start1, size1, start2, size2);
+
+		mixDown(buffer, 0, start1, size1);
+		mixDown(buffer, size1, start2, size2);
+
+		fifo.finishedWrite(size1 + size2);
+	}
+
+	//analyzer thread, returns how many samples were copied
+	int pull(float* destination, int maxSamples) noexcept
+	{
+		int start1, size1, start2, size2;
+		fifo.prepareToRead(maxSamples, start1, size1, start2, size2);
+
+		if (size1 > 0)
+			juce::FloatVectorOperations::copy(destination, storage.data() + start1, size1);
+
+		if (size2 > 0)
+			juce::FloatVectorOperations::copy(destination + size1, storage.data() + start2, size2);
+
+		fifo.finishedRead(size1 + size2);
+		return size1 + size2;
+	}
+
+	int getNumReady() const noexcept { return fifo.getNumReady(); }
+
+private:
+	void mixDown(const juce::AudioBuffer<float>& buffer, int sourceStart, int destStart, int numSamples) noexcept
+	{
+		const auto numChannels = buffer.getNumChannels();
+
+		if (numSamples <= 0 || numChannels == 0)
+			return;
+
+		const auto gain = 1.f / static_cast<float>(numChannels);
+		auto* destination = storage.data() + destStart;
+
+		juce::FloatVectorOperations::copyWithMultiply(destination, buffer.getReadPointer(0, sourceStart), gain, numSamples);
+
+		for (int ch = 1; ch < numChannels; ++ch)
+			juce::FloatVectorOperations::addWithMultiply(destination, buffer.getReadPointer(ch, sourceStart), gain, numSamples);
+	}
+
+	juce::AbstractFifo fifo{ capacity };
+	std::vector<float> storage;
+
+	JUCE_DECLARE_NON_COPYABLE(AnalyzerFifo)
+};
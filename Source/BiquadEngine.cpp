@@ -0,0 +1,536 @@
+/*
+  ==============================================================================
+
+    Runs the whole equalizer chain for several channels at once.
+
+  ==============================================================================
+*/
+
+#include "BiquadEngine.h"
+
+void BiquadEngine::prepare(int channels, int maximumBlockSize, bool isStereoPair)
+{
+	jassert(channels > 0 && channels <= maxChannels);
+	jassert(!isStereoPair || channels == 2);
+
+	numChannels = channels;
+	stereoPair = isStereoPair;
+	interleaved.assign(static_cast<size_t>(maximumBlockSize), Vec::expand(0.f));
+
+	setCoefficients({});
+	reset();
+}
+
+void BiquadEngine::reset()
+{
+	chainData.s1.fill(Vec::expand(0.f));
+	chainData.s2.fill(Vec::expand(0.f));
+}
+
+void BiquadEngine::copyFrom(const BiquadEngine& other) noexcept
+{
+	chainData = other.chainData;
+	target = other.target;
+}
+
+BiquadEngine::Section BiquadEngine::getSection(const ChainCoefficients& chainCoefficients, int id) const noexcept
+{
+	const BiquadCoefficients* first;
+	const BiquadCoefficients* second;
+
+	if (id < Bands)
+	{
+		first = &chainCoefficients.lowCut[id - LowCut];
+		second = &chainCoefficients.secondLowCut[id - LowCut];
+	}
+	else if (id < HighCut)
+	{
+		first = &chainCoefficients.bands[id - Bands];
+		second = &chainCoefficients.secondBands[id - Bands];
+	}
+	else
+	{
+		first = &chainCoefficients.highCut[id - HighCut];
+		second = &chainCoefficients.secondHighCut[id - HighCut];
+	}
+
+	Section section{ Vec::expand(first->b0), Vec::expand(first->b1), Vec::expand(first->b2), Vec::expand(first->a1), Vec::expand(first->a2) };
+
+	if (chainData.stereoMode != Stereo_Linked) //the second channel of the pair, the lanes past it are never read
+	{
+		section.b0.set(1, second->b0);
+		section.b1.set(1, second->b1);
+		section.b2.set(1, second->b2);
+		section.a1.set(1, second->a1);
+		section.a2.set(1, second->a2);
+	}
+
+	return section;
+}
+
+void BiquadEngine::setSlot(int slot, const Section& section) noexcept
+{
+	chainData.b0[slot] = section.b0;
+	chainData.b1[slot] = section.b1;
+	chainData.b2[slot] = section.b2;
+	chainData.a1[slot] = section.a1;
+	chainData.a2[slot] = section.a2;
+}
+
+void BiquadEngine::setStereoMode(const ChainCoefficients& chainCoefficients) noexcept
+{
+	const auto stereoMode = stereoPair ? chainCoefficients.stereoMode : Stereo_Linked;
+	convertStates(chainData.stereoMode, stereoMode);
+
+	chainData.stereoMode = stereoMode;
+	chainData.bandChannels = chainCoefficients.bandChannels;
+}
+
+void BiquadEngine::convertStates(StereoMode from, StereoMode to) noexcept
+{
+	if ((from == Stereo_MidSide) == (to == Stereo_MidSide))
+		return;
+
+	//the filters are linear, so while both lanes run the same sections the encoded states are
+	//exactly what the states would have been on the encoded signal
+	const auto scale = to == Stereo_MidSide ? 0.5f : 1.f;
+
+	auto convert = [scale](Vec& state)
+	{
+		const auto a = state.get(0), b = state.get(1);
+		state.set(0, (a + b) * scale);
+		state.set(1, (a - b) * scale);
+	};
+
+	for (int slot = 0; slot < chainData.numActive; ++slot)
+	{
+		convert(chainData.s1[slot]);
+		convert(chainData.s2[slot]);
+	}
+}
+
+void BiquadEngine::updateLayout(Slope lowCutSlope, Slope highCutSlope, juce::uint32 activeBands) noexcept
+{
+	std::array<int, NumSections> ids;
+	int numActive = 0;
+
+	for (int i = 0; i <= lowCutSlope; ++i)
+		ids[numActive++] = LowCut + i;
+
+	for (int band = 0; band < maxBands; ++band)
+		if ((activeBands >> band) & 1u)
+			ids[numActive++] = Bands + band;
+
+	for (int i = 0; i <= highCutSlope; ++i)
+		ids[numActive++] = HighCut + i;
+
+	chainData.lowCutSlope = lowCutSlope;
+	chainData.highCutSlope = highCutSlope;
+	chainData.activeBands = activeBands;
+	chainData.heldBands &= activeBands; //a held band that is left out has nothing to hold on to
+
+	if (numActive == chainData.numActive && std::equal(ids.begin(), ids.begin() + numActive, chainData.ids.begin()))
+		return;
+
+	//sections that keep running carry their states and coefficients over, sections coming in start from silence
+	const auto zero = Vec::expand(0.f), one = Vec::expand(1.f);
+	const auto previous = chainData;
+	std::array<int, NumSections> slots;
+	slots.fill(-1);
+
+	for (int slot = 0; slot < numActive; ++slot)
+	{
+		const auto from = previous.numActive > 0 ? previous.slots[ids[slot]] : -1;
+
+		if (from >= 0)
+		{
+			chainData.s1[slot] = previous.s1[from];
+			chainData.s2[slot] = previous.s2[from];
+			setSlot(slot, { previous.b0[from], previous.b1[from], previous.b2[from], previous.a1[from], previous.a2[from] });
+		}
+		else
+		{
+			chainData.s1[slot] = chainData.s2[slot] = zero;
+			setSlot(slot, { one, zero, zero, zero, zero });
+		}
+
+		slots[ids[slot]] = slot;
+	}
+
+	chainData.ids = ids;
+	chainData.slots = slots;
+	chainData.numActive = numActive;
+}
+
+void BiquadEngine::settle() noexcept
+{
+	if (chainData.rampLength <= 0)
+		return;
+
+	const auto position = static_cast<double>(chainData.rampPosition);
+
+	//worked out in double and rounded once, like the designs are
+	auto move = [position](Vec& value, Vec step)
+	{
+		for (size_t lane = 0; lane < Vec::SIMDNumElements; ++lane)
+			value.set(lane, static_cast<float>(static_cast<double>(value.get(lane)) + static_cast<double>(step.get(lane)) * position));
+	};
+
+	for (int slot = 0; slot < chainData.numActive; ++slot)
+	{
+		if (((chainData.rampGroups >> (slot / maxGroupSize)) & 1u) == 0)
+			continue;
+
+		move(chainData.b0[slot], chainData.db0[slot]);
+		move(chainData.b1[slot], chainData.db1[slot]);
+		move(chainData.b2[slot], chainData.db2[slot]);
+		move(chainData.a1[slot], chainData.da1[slot]);
+		move(chainData.a2[slot], chainData.da2[slot]);
+	}
+
+	chainData.rampLength = chainData.rampPosition = 0;
+	chainData.rampGroups = 0;
+}
+
+void BiquadEngine::applyTarget() noexcept
+{
+	updateLayout(target.lowCutSlope, target.highCutSlope, target.activeBands);
+	setStereoMode(target);
+
+	for (int slot = 0; slot < chainData.numActive; ++slot)
+	{
+		const auto id = chainData.ids[slot];
+
+		if (id >= Bands && id < HighCut && ((chainData.heldBands >> (id - Bands)) & 1u) != 0)
+			continue;
+
+		setSlot(slot, getSection(target, id));
+	}
+}
+
+void BiquadEngine::setCoefficients(const ChainCoefficients& chainCoefficients)
+{
+	settle();
+	target = chainCoefficients;
+	applyTarget();
+}
+
+void BiquadEngine::rampTo(const ChainCoefficients& chainCoefficients, int numSamples)
+{
+	if (numSamples <= 0)
+	{
+		setCoefficients(chainCoefficients);
+		return;
+	}
+
+	settle();
+	target = chainCoefficients;
+
+	//everything that runs now or will run at the end, the sections that fade out go at the end of the ramp
+	updateLayout(juce::jmax(chainData.lowCutSlope, target.lowCutSlope), juce::jmax(chainData.highCutSlope, target.highCutSlope),
+		chainData.activeBands | target.activeBands);
+	setStereoMode(target);
+
+	const auto zero = Vec::expand(0.f);
+
+	//the step is taken in double from the two designs and rounded once, instead of rounding the
+	//difference, the reciprocal and their product on the way
+	auto getStep = [numSamples](Vec start, Vec end)
+	{
+		Vec step;
+
+		for (size_t lane = 0; lane < Vec::SIMDNumElements; ++lane)
+			step.set(lane, static_cast<float>((static_cast<double>(end.get(lane)) - static_cast<double>(start.get(lane))) / numSamples));
+
+		return step;
+	};
+
+	auto moves = [](Vec start, Vec end)
+	{
+		for (size_t lane = 0; lane < Vec::SIMDNumElements; ++lane)
+			if (start.get(lane) != end.get(lane))
+				return true;
+
+		return false;
+	};
+
+	for (int slot = 0; slot < chainData.numActive; ++slot)
+	{
+		const auto id = chainData.ids[slot];
+		const auto held = id >= Bands && id < HighCut && ((chainData.heldBands >> (id - Bands)) & 1u) != 0;
+		const auto end = held ? Section{ chainData.b0[slot], chainData.b1[slot], chainData.b2[slot], chainData.a1[slot], chainData.a2[slot] }
+			: getSection(target, id);
+
+		//sections that already sit on the target are left to the plain kernels
+		if (!moves(chainData.b0[slot], end.b0) && !moves(chainData.b1[slot], end.b1) && !moves(chainData.b2[slot], end.b2)
+			&& !moves(chainData.a1[slot], end.a1) && !moves(chainData.a2[slot], end.a2))
+		{
+			chainData.db0[slot] = chainData.db1[slot] = chainData.db2[slot] = chainData.da1[slot] = chainData.da2[slot] = zero;
+			continue;
+		}
+
+		chainData.db0[slot] = getStep(chainData.b0[slot], end.b0);
+		chainData.db1[slot] = getStep(chainData.b1[slot], end.b1);
+		chainData.db2[slot] = getStep(chainData.b2[slot], end.b2);
+		chainData.da1[slot] = getStep(chainData.a1[slot], end.a1);
+		chainData.da2[slot] = getStep(chainData.a2[slot], end.a2);
+		chainData.rampGroups |= 1u << (slot / maxGroupSize);
+	}
+
+	if (chainData.rampGroups == 0) //nothing moves, only the layout may still have to shrink
+	{
+		applyTarget();
+		return;
+	}
+
+	chainData.rampLength = numSamples;
+	chainData.rampPosition = 0;
+}
+
+void BiquadEngine::finishRamp() noexcept
+{
+	if (chainData.rampLength <= 0)
+		return;
+
+	chainData.rampLength = chainData.rampPosition = 0;
+	chainData.rampGroups = 0;
+	applyTarget();
+}
+
+void BiquadEngine::setBandCoefficients(int band, const BiquadCoefficients& coefficients) noexcept
+{
+	const auto slot = chainData.slots[Bands + band];
+
+	if (slot < 0)
+		return;
+
+	chainData.heldBands |= 1u << band;
+
+	const auto zero = Vec::expand(0.f);
+	chainData.db0[slot] = chainData.db1[slot] = chainData.db2[slot] = chainData.da1[slot] = chainData.da2[slot] = zero;
+
+	Section section{ Vec::expand(coefficients.b0), Vec::expand(coefficients.b1), Vec::expand(coefficients.b2),
+		Vec::expand(coefficients.a1), Vec::expand(coefficients.a2) };
+
+	if (chainData.stereoMode != Stereo_Linked)
+	{
+		const auto channel = chainData.bandChannels[static_cast<size_t>(band)];
+		const BiquadCoefficients passThrough;
+		const auto& first = channel == Channel_Second ? passThrough : coefficients;
+		const auto& second = channel == Channel_First ? passThrough : coefficients;
+
+		section = { Vec::expand(first.b0), Vec::expand(first.b1), Vec::expand(first.b2), Vec::expand(first.a1), Vec::expand(first.a2) };
+		section.b0.set(1, second.b0);
+		section.b1.set(1, second.b1);
+		section.b2.set(1, second.b2);
+		section.a1.set(1, second.a1);
+		section.a2.set(1, second.a2);
+	}
+
+	setSlot(slot, section);
+}
+
+void BiquadEngine::releaseBand(int band, int numSamples)
+{
+	chainData.heldBands &= ~(1u << band);
+	rampTo(target, numSamples);
+}
+
+const std::array<BiquadEngine::CascadeKernel, BiquadEngine::maxGroupSize + 1> BiquadEngine::cascadeKernels
+{
+	nullptr,
+	&processCascade<1>,
+	&processCascade<2>,
+	&processCascade<3>,
+	&processCascade<4>
+};
+
+const std::array<BiquadEngine::RampKernel, BiquadEngine::maxGroupSize + 1> BiquadEngine::rampKernels
+{
+	nullptr,
+	&processCascadeRamp<1>,
+	&processCascadeRamp<2>,
+	&processCascadeRamp<3>,
+	&processCascadeRamp<4>
+};
+
+template <int numSections>
+void BiquadEngine::processCascade(ChainData& d, int first, Vec* samples, int numSamples) noexcept
+{
+	Vec b0[numSections], b1[numSections], b2[numSections], a1[numSections], a2[numSections];
+	Vec s1[numSections], s2[numSections];
+
+	for (int k = 0; k < numSections; ++k)
+	{
+		b0[k] = d.b0[first + k];
+		b1[k] = d.b1[first + k];
+		b2[k] = d.b2[first + k];
+		a1[k] = d.a1[first + k];
+		a2[k] = d.a2[first + k];
+		s1[k] = d.s1[first + k];
+		s2[k] = d.s2[first + k];
+	}
+
+	for (int i = 0; i < numSamples; ++i)
+	{
+		auto x = samples[i];
+
+		for (int k = 0; k < numSections; ++k) //unrolled, numSections is known at compile time
+		{
+			const auto y = b0[k] * x + s1[k];
+
+			s1[k] = b1[k] * x - a1[k] * y + s2[k];
+			s2[k] = b2[k] * x - a2[k] * y;
+
+			x = y;
+		}
+
+		samples[i] = x;
+	}
+
+	for (int k = 0; k < numSections; ++k)
+	{
+		d.s1[first + k] = s1[k];
+		d.s2[first + k] = s2[k];
+	}
+}
+
+template <int numSections>
+void BiquadEngine::processCascadeRamp(ChainData& d, int first, Vec* samples, int numSamples, int position) noexcept
+{
+	Vec b0[numSections], b1[numSections], b2[numSections], a1[numSections], a2[numSections];
+	Vec db0[numSections], db1[numSections], db2[numSections], da1[numSections], da2[numSections];
+	Vec s1[numSections], s2[numSections];
+
+	for (int k = 0; k < numSections; ++k)
+	{
+		b0[k] = d.b0[first + k];
+		b1[k] = d.b1[first + k];
+		b2[k] = d.b2[first + k];
+		a1[k] = d.a1[first + k];
+		a2[k] = d.a2[first + k];
+		db0[k] = d.db0[first + k];
+		db1[k] = d.db1[first + k];
+		db2[k] = d.db2[first + k];
+		da1[k] = d.da1[first + k];
+		da2[k] = d.da2[first + k];
+		s1[k] = d.s1[first + k];
+		s2[k] = d.s2[first + k];
+	}
+
+	auto t = Vec::expand(static_cast<float>(position + 1)); //the first sample already moves one step
+	const auto one = Vec::expand(1.f);
+
+	for (int i = 0; i < numSamples; ++i)
+	{
+		auto x = samples[i];
+
+		for (int k = 0; k < numSections; ++k)
+		{
+			const auto y = (b0[k] + db0[k] * t) * x + s1[k];
+
+			s1[k] = (b1[k] + db1[k] * t) * x - (a1[k] + da1[k] * t) * y + s2[k];
+			s2[k] = (b2[k] + db2[k] * t) * x - (a2[k] + da2[k] * t) * y;
+
+			x = y;
+		}
+
+		samples[i] = x;
+		t = t + one;
+	}
+
+	for (int k = 0; k < numSections; ++k)
+	{
+		d.s1[first + k] = s1[k];
+		d.s2[first + k] = s2[k];
+	}
+}
+
+void BiquadEngine::processSections(Vec* samples, int numSamples) noexcept
+{
+	//a ramp runs the groups that move through the ramp kernel, up to where it ends. That is the
+	//only place the block is split, after it the chain is back on the plain kernels
+	while (chainData.rampLength > 0 && numSamples > 0)
+	{
+		const auto length = juce::jmin(numSamples, chainData.rampLength - chainData.rampPosition);
+
+		for (int first = 0; first < chainData.numActive; first += maxGroupSize)
+		{
+			const auto size = juce::jmin(maxGroupSize, chainData.numActive - first);
+
+			if ((chainData.rampGroups >> (first / maxGroupSize)) & 1u)
+				rampKernels[size](chainData, first, samples, length, chainData.rampPosition);
+			else
+				cascadeKernels[size](chainData, first, samples, length);
+		}
+
+		chainData.rampPosition += length;
+		samples += length;
+		numSamples -= length;
+
+		if (chainData.rampPosition >= chainData.rampLength)
+			finishRamp();
+	}
+
+	//only the packed sections, in as few passes over the block as the registers allow
+	for (int first = 0; first < chainData.numActive && numSamples > 0; first += maxGroupSize)
+		cascadeKernels[juce::jmin(maxGroupSize, chainData.numActive - first)](chainData, first, samples, numSamples);
+}
+
+void BiquadEngine::process(const juce::dsp::AudioBlock<float>& block)
+{
+	const auto numSamples = static_cast<int>(block.getNumSamples());
+	const auto channels = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()));
+
+	jassert(numSamples <= static_cast<int>(interleaved.size()));
+
+	auto* lanes = reinterpret_cast<float*>(interleaved.data());
+	const auto midSide = chainData.stereoMode == Stereo_MidSide && channels == 2;
+
+	if (midSide) //encoded on the way into the lanes, no extra pass over the block
+	{
+		const auto* left = block.getChannelPointer(0);
+		const auto* right = block.getChannelPointer(1);
+
+		for (int i = 0; i < numSamples; ++i)
+		{
+			lanes[i * maxChannels] = 0.5f * (left[i] + right[i]);
+			lanes[i * maxChannels + 1] = 0.5f * (left[i] - right[i]);
+		}
+	}
+	else
+	{
+		for (int ch = 0; ch < channels; ++ch) //one channel per lane
+		{
+			const auto* input = block.getChannelPointer(static_cast<size_t>(ch));
+
+			for (int i = 0; i < numSamples; ++i)
+				lanes[i * maxChannels + ch] = input[i];
+		}
+	}
+
+	processSections(interleaved.data(), numSamples);
+
+	if (midSide) //and decoded on the way out
+	{
+		auto* left = block.getChannelPointer(0);
+		auto* right = block.getChannelPointer(1);
+
+		for (int i = 0; i < numSamples; ++i)
+		{
+			const auto mid = lanes[i * maxChannels], side = lanes[i * maxChannels + 1];
+			left[i] = mid + side;
+			right[i] = mid - side;
+		}
+
+		return;
+	}
+
+	for (int ch = 0; ch < channels; ++ch)
+	{
+		auto* output = block.getChannelPointer(static_cast<size_t>(ch));
+
+		for (int i = 0; i < numSamples; ++i)
+			output[i] = lanes[i * maxChannels + ch];
+	}
+}
@@ -0,0 +1,159 @@
+/*
+  ==============================================================================
+
+    Runs the whole equalizer chain for several channels at once. Every
+    channel gets one lane of a juce::dsp::SIMDRegister, so a stereo pair is
+    filtered with the same instructions that used to filter one channel.
+
+    The coefficients and states are kept as one array per coefficient, and
+    only the sections that actually do something are packed into the front
+    of them: the low cut's sections, the active bands, the high cut's. A
+    disabled band costs nothing while processing, the packed list is run in
+    groups of up to four sections that keep their states in registers.
+
+    An engine running the two channels of a stereo layout can give its two
+    lanes different coefficients, for the left/right and mid/side modes.
+    That is the same code path, only the coefficients differ per lane, and
+    the mid/side encode and decode happen in the interleaving loops.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterCoefficients.h"
+
+class BiquadEngine
+{
+public:
+	using Vec = juce::dsp::SIMDRegister<float>;
+
+	static constexpr int maxChannels = static_cast<int>(Vec::SIMDNumElements); //one lane per channel
+
+	//stereoPair is set for the engine running channels 0 and 1 of a stereo layout, the only one the stereo modes apply to
+	void prepare(int numChannels, int maximumBlockSize, bool stereoPair);
+	void reset();
+
+	//takes over the other engine's coefficients, filter states and ramp, so this one carries on exactly
+	//where the other one is. Never allocates
+	void copyFrom(const BiquadEngine& other) noexcept;
+
+	//jumps straight to the set, ending any ramp
+	void setCoefficients(const ChainCoefficients& chainCoefficients);
+
+	//glides from wherever the chain is to the set over the next numSamples samples. Every sample gets
+	//its own coefficients, but only the sections that differ are ramped, and the block is only split
+	//where the ramp ends, so the cost depends on how many changes there are and not on the block size
+	void rampTo(const ChainCoefficients& chainCoefficients, int numSamples);
+
+	bool isRamping() const noexcept { return chainData.rampLength > 0; }
+
+	//lands on the ramp's target right away, for when nothing is being processed that could click
+	void finishRamp() noexcept;
+
+	//only one band's section, for the dynamic mode that redesigns it at control rate. The band keeps
+	//these coefficients through new sets and ramps until it is released. A band that isn't active in
+	//the current set is left out of the chain and ignores this
+	void setBandCoefficients(int band, const BiquadCoefficients& coefficients) noexcept;
+
+	//hands the band back to the sets, gliding to the current one over numSamples
+	void releaseBand(int band, int numSamples);
+
+	//how many sections each sample runs through right now
+	int getNumActiveSections() const noexcept { return chainData.numActive; }
+
+	//how the set that is running treats the stereo pair and where it puts the band
+	StereoMode getStereoMode() const noexcept { return chainData.stereoMode; }
+	BandChannel getBandChannel(int band) const noexcept { return chainData.bandChannels[static_cast<size_t>(band)]; }
+
+	//filters the block in place, it must not have more channels than were prepared
+	void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+	enum ChainPosition //the id of every section the chain can have, in processing order
+	{
+		LowCut = 0,
+		Bands = LowCut + maxCutSections,
+		HighCut = Bands + maxBands,
+		NumSections = HighCut + maxCutSections
+	};
+
+	static constexpr int maxGroupSize = 4;	//sections per kernel call, all their states fit into registers
+
+	//transposed direct form II, structure of arrays: element k of every array belongs to the k-th
+	//active section, and every state carries one value per lane. One contiguous block, starting on a cache line
+	struct alignas(64) ChainData
+	{
+		std::array<Vec, NumSections> b0, b1, b2, a1, a2;		//where the ramp started while there is one
+		std::array<Vec, NumSections> s1, s2;
+		std::array<Vec, NumSections> db0, db1, db2, da1, da2;	//how far the ramp moves them per sample
+
+		std::array<int, NumSections> ids{};		//which section sits in each packed slot
+		std::array<int, NumSections> slots{};	//and the other way round, -1 for the ones left out
+		int numActive{ 0 };
+
+		Slope lowCutSlope{ Slope_12 }, highCutSlope{ Slope_12 };	//what the packed sections are made of
+		juce::uint32 activeBands{ 0 };
+
+		StereoMode stereoMode{ Stereo_Linked };	//only ever something else in a stereo pair
+		std::array<BandChannel, maxBands> bandChannels{};
+
+		juce::uint32 heldBands{ 0 };			//set through setBandCoefficients, new sets leave them alone
+
+		int rampLength{ 0 }, rampPosition{ 0 };
+		juce::uint32 rampGroups{ 0 };			//bit g set when group g has sections that move
+	};
+
+	struct Section //one section's coefficients as the lanes see them
+	{
+		Vec b0, b1, b2, a1, a2;
+	};
+
+	//runs numSections cascaded sections, starting at packed slot first, over the interleaved block. The
+	//section count is a template argument so the inner loop is unrolled and the states stay in registers
+	template <int numSections>
+	static void processCascade(ChainData& data, int first, Vec* samples, int numSamples) noexcept;
+
+	//the same while ramping: sample i of the ramp runs start + i * step, so the coefficients stay
+	//between the two designs and nothing adds up over a long ramp. The step is rounded from double
+	//once, after that each coefficient is at most a couple of float roundings off the exact line between
+	//the two designs, a few 1e-7 of the larger of them, which is what rounding the design to float costs
+	//anyway. Nothing accumulates, and the exact target is written once the ramp is over
+	template <int numSections>
+	static void processCascadeRamp(ChainData& data, int first, Vec* samples, int numSamples, int position) noexcept;
+
+	using CascadeKernel = void (*)(ChainData&, int, Vec*, int) noexcept;
+	using RampKernel = void (*)(ChainData&, int, Vec*, int, int) noexcept;
+
+	static const std::array<CascadeKernel, maxGroupSize + 1> cascadeKernels; //by group size
+	static const std::array<RampKernel, maxGroupSize + 1> rampKernels;
+
+	void processSections(Vec* samples, int numSamples) noexcept;
+
+	//packs the sections the layout needs, keeping the states and coefficients of those that were
+	//running already. Sections coming in start from silence and pass the signal through
+	void updateLayout(Slope lowCutSlope, Slope highCutSlope, juce::uint32 activeBands) noexcept;
+
+	Section getSection(const ChainCoefficients& chainCoefficients, int id) const noexcept;
+	void setSlot(int slot, const Section& section) noexcept;
+
+	void setStereoMode(const ChainCoefficients& chainCoefficients) noexcept;
+
+	//carries the states over into the other domain when mid/side is switched on or off, so the
+	//filters go on from where they are instead of ringing out from a step
+	void convertStates(StereoMode from, StereoMode to) noexcept;
+
+	//moves the coefficients to where the running ramp has got them and ends it
+	void settle() noexcept;
+
+	//writes the target into every slot but the held bands
+	void applyTarget() noexcept;
+
+	ChainData chainData;
+	ChainCoefficients target;	//the last set, what a ramp ends on
+
+	std::vector<Vec> interleaved; //sample i of channel c lives in lane c of interleaved[i]
+	int numChannels{ 0 };
+	bool stereoPair{ false };
+};
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    Parameter snapshot of the equalizer chain, shared by the processor and
+    the coefficient designer.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+enum Slope //C++ doesnt allow numbers as VariableIdentifiers so i made an enum to correctly say what the variable represents
+{
+	Slope_12,
+	Slope_24,
+	Slope_36,
+	Slope_48
+};
+
+enum BandType //the order of the "Type" parameter choices
+{
+	Band_Peak,
+	Band_LowShelf,
+	Band_HighShelf,
+	Band_Notch,
+	Band_BandPass
+};
+
+static constexpr int maxBands = 8; //bands between the two cuts, the first one is the original peak band
+
+enum Oversampling //the factor is 1 << value
+{
+	Oversampling_Off,
+	Oversampling_2x,
+	Oversampling_4x
+};
+
+enum StereoMode //how the two channels of a stereo layout are treated, other layouts are always linked
+{
+	Stereo_Linked,		//every band on both channels
+	Stereo_LeftRight,	//each band on the channels it is placed on
+	Stereo_MidSide		//the same on mid and side, encoded and decoded inside the chain
+};
+
+enum BandChannel //where a band sits outside of the linked mode
+{
+	Channel_Both,
+	Channel_First,		//left, or mid
+	Channel_Second		//right, or side
+};
+
+struct BandSettings
+{
+	bool enabled{ false };
+	BandType type{ Band_Peak };
+	float frequency{ 750.f }, gainInDecibels{ 0 }, quality{ 1.f };	//notch and band pass ignore the gain
+	BandChannel channel{ Channel_Both };
+};
+
+struct ChainSettings //all Parameters added
+{
+	std::array<BandSettings, maxBands> bands;
+	float lowCutFreq{ 0 }, highCutFreq{ 0 };
+
+	Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+
+	Oversampling oversampling{ Oversampling::Oversampling_Off };
+	bool linearPhase{ false };
+
+	StereoMode stereoMode{ Stereo_Linked };
+	BandChannel lowCutChannel{ Channel_Both }, highCutChannel{ Channel_Both };
+}; 
+
+ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
+
+//"Peak Freq", "Band2 Freq" and so on: band 0 keeps the IDs it always had, so old sessions still load into it
+inline juce::String getBandParameterID(int band, const char* name)
+{
+	return (band == 0 ? juce::String("Peak ") : "Band" + juce::String(band + 1) + " ") + name;
+}
+
+//per band comparisons so only the band that actually moved gets redesigned
+inline bool lowCutChanged(const ChainSettings& a, const ChainSettings& b)
+{
+	return a.lowCutFreq != b.lowCutFreq || a.lowCutSlope != b.lowCutSlope;
+}
+
+inline bool highCutChanged(const ChainSettings& a, const ChainSettings& b)
+{
+	return a.highCutFreq != b.highCutFreq || a.highCutSlope != b.highCutSlope;
+}
+
+inline bool bandChanged(const ChainSettings& a, const ChainSettings& b, int band)
+{
+	const auto& x = a.bands[static_cast<size_t>(band)];
+	const auto& y = b.bands[static_cast<size_t>(band)];
+
+	if (x.enabled != y.enabled)
+		return true;
+
+	//a band that stays off can move all it likes
+	return x.enabled && (x.type != y.type || x.frequency != y.frequency || x.gainInDecibels != y.gainInDecibels || x.quality != y.quality);
+}
+
+inline bool bandsChanged(const ChainSettings& a, const ChainSettings& b)
+{
+	for (int band = 0; band < maxBands; ++band)
+		if (bandChanged(a, b, band))
+			return true;
+
+	return false;
+}
+
+inline bool oversamplingChanged(const ChainSettings& a, const ChainSettings& b)
+{
+	return a.oversampling != b.oversampling;
+}
+
+inline bool linearPhaseChanged(const ChainSettings& a, const ChainSettings& b)
+{
+	return a.linearPhase != b.linearPhase;
+}
+
+//nothing needs a redesign for these, the designs are only split up differently between the channels
+inline bool stereoChanged(const ChainSettings& a, const ChainSettings& b)
+{
+	if (a.stereoMode != b.stereoMode || a.lowCutChannel != b.lowCutChannel || a.highCutChannel != b.highCutChannel)
+		return true;
+
+	for (size_t band = 0; band < a.bands.size(); ++band)
+		if (a.bands[band].channel != b.bands[band].channel)
+			return true;
+
+	return false;
+}
@@ -0,0 +1,140 @@
+/*
+  ==============================================================================
+
+    Designs the coefficients for the equalizer chain away from the audio
+    thread and publishes finished sets through a TripleBuffer.
+
+  ==============================================================================
+*/
+
+#include "CoefficientDesigner.h"
+
+CoefficientDesigner::CoefficientDesigner(SettingsSource settingsSource)
+	: getSettings(std::move(settingsSource))
+{
+}
+
+CoefficientDesigner::~CoefficientDesigner()
+{
+	release();
+}
+
+void CoefficientDesigner::prepare(double sampleRate, bool watchParameters)
+{
+	{
+		const juce::ScopedLock sl(designLock);
+
+		baseSampleRate = sampleRate;
+
+		for (int factor = Oversampling_Off; factor <= Oversampling_4x; ++factor)
+			cutTables[static_cast<size_t>(factor)] = cutFilterTables->getTable(sampleRate * (1 << factor));
+
+		designAndPublish(getSettings(), true);
+	}
+
+	watching = watchParameters;
+
+	if (watching)
+		designerThread->addTimeSliceClient(this);
+}
+
+void CoefficientDesigner::release()
+{
+	designerThread->removeTimeSliceClient(this); //waits until a running design has finished
+}
+
+void CoefficientDesigner::designNow()
+{
+	const juce::ScopedLock sl(designLock);
+
+	if (baseSampleRate > 0.0) //before prepare() there is nothing to design for, prepare() will do it
+		designAndPublish(getSettings(), false);
+}
+
+const ChainCoefficients* CoefficientDesigner::pullLatest() noexcept
+{
+	if (published.pull())
+		return &published.getReadSlot();
+
+	return nullptr;
+}
+
+const ChainCoefficients* CoefficientDesigner::designForBlock()
+{
+	jassert(!watching); //the designer thread would be publishing as well
+
+	{
+		const juce::ScopedLock sl(designLock); //uncontended, designNow() isn't used without watching
+
+		const auto chainSettings = getSettings();
+
+		if (settingsChanged(chainSettings))
+			designAndPublish(chainSettings, false);
+	}
+
+	return pullLatest(); //also picks up what designNow() published
+}
+
+int CoefficientDesigner::useTimeSlice()
+{
+	const juce::ScopedLock sl(designLock);
+
+	auto chainSettings = getSettings();
+
+	if (!settingsChanged(chainSettings))
+		return idleIntervalMs;
+
+	designAndPublish(chainSettings, false);
+	return activeIntervalMs;
+}
+
+bool CoefficientDesigner::settingsChanged(const ChainSettings& chainSettings) const noexcept
+{
+	return lowCutChanged(chainSettings, lastSettings)
+		|| highCutChanged(chainSettings, lastSettings)
+		|| bandsChanged(chainSettings, lastSettings)
+		|| oversamplingChanged(chainSettings, lastSettings)
+		|| linearPhaseChanged(chainSettings, lastSettings)
+		|| stereoChanged(chainSettings, lastSettings);
+}
+
+void CoefficientDesigner::designAndPublish(const ChainSettings& chainSettings, bool redesignAll)
+{
+	const auto sampleRate = baseSampleRate * (1 << chainSettings.oversampling);
+
+	if (sampleRate != lastCoefficients.sampleRate) //new oversampling factor, nothing of the old design fits
+	{
+		lastCoefficients.sampleRate = sampleRate;
+		redesignAll = true;
+	}
+
+	//only the bands that moved get redesigned, the others keep their last design
+	const auto& cutTable = *cutTables[static_cast<size_t>(chainSettings.oversampling)];
+
+	if (redesignAll || lowCutChanged(chainSettings, lastSettings))
+	{
+		cutTable.makeLowCutCoefficients(lastCoefficients.lowCut, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+		lastCoefficients.lowCutSlope = chainSettings.lowCutSlope;
+	}
+
+	if (redesignAll || highCutChanged(chainSettings, lastSettings))
+	{
+		cutTable.makeHighCutCoefficients(lastCoefficients.highCut, chainSettings.highCutFreq, chainSettings.highCutSlope);
+		lastCoefficients.highCutSlope = chainSettings.highCutSlope;
+	}
+
+	for (int band = 0; band < maxBands; ++band)
+		if (redesignAll || bandChanged(chainSettings, lastSettings, band))
+			designCache->makeBandCoefficients(lastCoefficients, chainSettings, band);
+
+	lastSettings = chainSettings;
+
+	//the designs stay whole in here, only what the chain gets is split between the channels
+	auto& slot = published.getWriteSlot();
+	slot = lastCoefficients;
+	applyStereoMode(slot, chainSettings);
+	published.publish();
+
+	if (onPublished != nullptr)
+		onPublished(chainSettings, lastCoefficients);
+}
@@ -0,0 +1,95 @@
+/*
+  ==============================================================================
+
+    Designs the coefficients for the equalizer chain away from the audio
+    thread and publishes finished sets through a TripleBuffer. Offline the
+    audio thread asks for each block's set itself, so a render comes out
+    the same however fast it runs.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "FilterCoefficients.h"
+#include "DesignCache.h"
+#include "CutFilterTables.h"
+#include "TripleBuffer.h"
+
+//one background thread shared by every plugin instance in the process
+struct CoefficientDesignerThread : juce::TimeSliceThread
+{
+	CoefficientDesignerThread() : juce::TimeSliceThread("EQ Coefficient Designer")
+	{
+		startThread();
+	}
+
+	~CoefficientDesignerThread() override
+	{
+		stopThread(2000);
+	}
+};
+
+class CoefficientDesigner : private juce::TimeSliceClient
+{
+public:
+	using SettingsSource = std::function<ChainSettings()>;
+
+	explicit CoefficientDesigner(SettingsSource settingsSource);
+	~CoefficientDesigner() override;
+
+	//designs the first set for the new sample rate right away and starts watching the parameters.
+	//Sets are designed for the oversampled rate, so ChainCoefficients::sampleRate can be a multiple of this.
+	//Without watchParameters nothing runs in the background and the audio thread calls designForBlock()
+	void prepare(double sampleRate, bool watchParameters);
+	void release();
+
+	//message thread, designs the current settings right away instead of on the next poll.
+	//Used after restoring a state so the new set is ready before the first block. Not needed, and
+	//not to be called, while prepared without watching: designForBlock() picks the values up itself
+	void designNow();
+
+	//audio thread only, wait free. Returns nullptr when nothing new was published since the last call
+	const ChainCoefficients* pullLatest() noexcept;
+
+	//audio thread, only when prepared without watching the parameters, for offline rendering. Designs
+	//the settings as they are right now if they moved, so every block gets the set for its own
+	//parameters no matter how fast the render runs. Returns what pullLatest() would
+	const ChainCoefficients* designForBlock();
+
+	//called on the publishing thread after each new set. That is the audio thread only when
+	//designForBlock() does the designing
+	std::function<void(const ChainSettings&, const ChainCoefficients&)> onPublished;
+
+private:
+	int useTimeSlice() override;
+
+	bool settingsChanged(const ChainSettings& chainSettings) const noexcept;
+	void designAndPublish(const ChainSettings& chainSettings, bool redesignAll);
+
+	static constexpr int idleIntervalMs = 10;	//how often the parameters are polled while nothing moves
+	static constexpr int activeIntervalMs = 1;	//while automation is running
+
+	SettingsSource getSettings;
+
+	//taken by prepare(), designNow() and the designer thread while watching. Without watching only
+	//prepare() and designForBlock() take it, and the host doesn't run those at the same time
+	juce::CriticalSection designLock;
+	double baseSampleRate{ 0.0 };
+	bool watching{ false };
+	ChainSettings lastSettings;
+	ChainCoefficients lastCoefficients;
+
+	TripleBuffer<ChainCoefficients> published;
+
+	juce::SharedResourcePointer<CoefficientDesignerThread> designerThread;
+	juce::SharedResourcePointer<DesignCache> designCache; //instances with the same settings share the work
+
+	//the cuts are read from tables for the host rate and both oversampled rates, shared with every instance at the same rate
+	juce::SharedResourcePointer<CutFilterTables> cutFilterTables;
+	std::array<std::shared_ptr<const CutFilterTable>, 3> cutTables;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CoefficientDesigner)
+};
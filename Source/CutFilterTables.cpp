@@ -0,0 +1,92 @@
+/*
+  ==============================================================================
+
+    Precomputed Butterworth sections for the low and high cut.
+
+  ==============================================================================
+*/
+
+#include "CutFilterTables.h"
+
+CutFilterTable::CutFilterTable(double newSampleRate)
+	: sampleRate(newSampleRate)
+{
+	const auto start = juce::Time::getHighResolutionTicks();
+
+	const auto numOctaves = std::log2(static_cast<double>(maxFrequency) / minFrequency);
+	numPoints = static_cast<int>(std::ceil(numOctaves * pointsPerOctave)) + 1;
+
+	lowCut.resize(static_cast<size_t>(numPoints * sectionsPerPoint));
+	highCut.resize(static_cast<size_t>(numPoints * sectionsPerPoint));
+
+	std::array<PreciseBiquadCoefficients, maxCutSections> sections;
+
+	for (int point = 0; point < numPoints; ++point)
+	{
+		const auto frequency = static_cast<float>(minFrequency * std::exp2(static_cast<double>(point) / pointsPerOctave));
+
+		for (int slope = Slope_12; slope <= Slope_48; ++slope)
+		{
+			const auto first = static_cast<size_t>(point * sectionsPerPoint + getFirstSection(static_cast<Slope>(slope)));
+
+			::makeLowCutCoefficients(sections, sampleRate, frequency, static_cast<Slope>(slope));
+			std::copy(sections.begin(), sections.begin() + slope + 1, lowCut.begin() + static_cast<std::ptrdiff_t>(first));
+
+			::makeHighCutCoefficients(sections, sampleRate, frequency, static_cast<Slope>(slope));
+			std::copy(sections.begin(), sections.begin() + slope + 1, highCut.begin() + static_cast<std::ptrdiff_t>(first));
+		}
+	}
+
+	buildMilliseconds = juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0;
+}
+
+void CutFilterTable::makeLowCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, float frequency, Slope slope) const noexcept
+{
+	lookup(lowCut, sections, frequency, slope);
+}
+
+void CutFilterTable::makeHighCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, float frequency, Slope slope) const noexcept
+{
+	lookup(highCut, sections, frequency, slope);
+}
+
+size_t CutFilterTable::getSizeInBytes() const noexcept
+{
+	return (lowCut.size() + highCut.size()) * sizeof(PreciseBiquadCoefficients);
+}
+
+void CutFilterTable::lookup(const std::vector<PreciseBiquadCoefficients>& table, std::array<BiquadCoefficients, maxCutSections>& sections,
+	float frequency, Slope slope) const noexcept
+{
+	const auto position = std::log2(static_cast<double>(juce::jlimit(minFrequency, maxFrequency, frequency)) / minFrequency) * pointsPerOctave;
+	const auto index = juce::jlimit(0, numPoints - 2, static_cast<int>(position));
+	const auto amount = juce::jlimit(0.0, 1.0, position - index);
+
+	//interpolating between two stable designs stays stable, see interpolate()
+	const auto* below = table.data() + index * sectionsPerPoint + getFirstSection(slope);
+	const auto* above = below + sectionsPerPoint;
+
+	for (int i = 0; i <= slope; ++i)
+		sections[static_cast<size_t>(i)] = toFloat(interpolate(below[i], above[i], amount));
+
+	for (int i = slope + 1; i < maxCutSections; ++i)
+		sections[static_cast<size_t>(i)] = {};
+}
+
+//==============================================================================
+std::shared_ptr<const CutFilterTable> CutFilterTables::getTable(double sampleRate)
+{
+	const juce::ScopedLock sl(lock);
+
+	for (auto& entry : tables)
+		if (auto table = entry.lock())
+			if (table->getSampleRate() == sampleRate)
+				return table;
+
+	//tables nobody holds any more make room for the new one
+	tables.erase(std::remove_if(tables.begin(), tables.end(), [](const auto& entry) { return entry.expired(); }), tables.end());
+
+	auto table = std::make_shared<const CutFilterTable>(sampleRate);
+	tables.push_back(table);
+	return table;
+}
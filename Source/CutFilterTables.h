@@ -0,0 +1,67 @@
+/*
+  ==============================================================================
+
+    Precomputed Butterworth sections for the low and high cut, one table per
+    sample rate. The frequency parameters only cover 20 Hz - 20 kHz and the
+    slopes are four fixed orders, so every section the cuts can ever need is
+    known up front. The table holds exact designs on a log spaced grid and a
+    lookup blends the two neighbouring points, which turns a cut frequency
+    change into a log2 and two reads.
+
+    The tables are flat arrays of plain floats without pointers, built once
+    per rate and shared read only by every instance running at that rate.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "FilterCoefficients.h"
+
+class CutFilterTable
+{
+public:
+	static constexpr float minFrequency = 20.f, maxFrequency = 20000.f;	//the range of the frequency parameters
+	static constexpr int pointsPerOctave = 64;	//as close to the exact design as float rounding allows, 0.15 dB right below nyquist at 32 kHz
+
+	explicit CutFilterTable(double sampleRate);
+
+	//any thread, never allocates. Same layout as the functions in FilterCoefficients.h: the first
+	//(slope + 1) sections are filled in, the rest are set to pass through
+	void makeLowCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, float frequency, Slope slope) const noexcept;
+	void makeHighCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, float frequency, Slope slope) const noexcept;
+
+	double getSampleRate() const noexcept { return sampleRate; }
+	size_t getSizeInBytes() const noexcept;
+	double getBuildMilliseconds() const noexcept { return buildMilliseconds; }
+
+private:
+	//every section of every slope at one grid point, slope s starts at s * (s + 1) / 2
+	static constexpr int sectionsPerPoint = 1 + 2 + 3 + 4;
+	static constexpr int getFirstSection(Slope slope) noexcept { return slope * (slope + 1) / 2; }
+
+	void lookup(const std::vector<PreciseBiquadCoefficients>& table, std::array<BiquadCoefficients, maxCutSections>& sections,
+		float frequency, Slope slope) const noexcept;
+
+	double sampleRate;
+	int numPoints{ 0 };
+	std::vector<PreciseBiquadCoefficients> lowCut, highCut;	//numPoints * sectionsPerPoint each, blended in double and rounded once
+	double buildMilliseconds{ 0.0 };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(CutFilterTable)
+};
+
+//process wide registry, reached through a SharedResourcePointer. A table lives for as long
+//as some instance holds on to it, the next instance at the same rate picks it up again
+class CutFilterTables
+{
+public:
+	//message thread or designer thread, builds the table on first use
+	std::shared_ptr<const CutFilterTable> getTable(double sampleRate);
+
+private:
+	juce::CriticalSection lock;		//never taken by the audio thread
+	std::vector<std::weak_ptr<const CutFilterTable>> tables;
+};
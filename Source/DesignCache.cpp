@@ -0,0 +1,174 @@
+/*
+  ==============================================================================
+
+    Process wide cache of finished band designs.
+
+  ==============================================================================
+*/
+
+#include "DesignCache.h"
+
+void DesignCache::makeLowCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings)
+{
+	const Key key{ FilterType::lowCut, static_cast<juce::uint32>(chainSettings.lowCutSlope), chainSettings.lowCutFreq, 0.f, 1.f, 0, coefficients.sampleRate };
+
+	getSections(key, coefficients.lowCut, [&](Sections& sections)
+	{
+		::makeLowCutCoefficients(sections, coefficients.sampleRate, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+	});
+
+	coefficients.lowCutSlope = chainSettings.lowCutSlope;
+}
+
+void DesignCache::makeHighCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings)
+{
+	const Key key{ FilterType::highCut, static_cast<juce::uint32>(chainSettings.highCutSlope), chainSettings.highCutFreq, 0.f, 1.f, 0, coefficients.sampleRate };
+
+	getSections(key, coefficients.highCut, [&](Sections& sections)
+	{
+		::makeHighCutCoefficients(sections, coefficients.sampleRate, chainSettings.highCutFreq, chainSettings.highCutSlope);
+	});
+
+	coefficients.highCutSlope = chainSettings.highCutSlope;
+}
+
+void DesignCache::makeBandCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band)
+{
+	const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+
+	if (!isBandActive(settings)) //nothing to design
+	{
+		::makeBandCoefficients(coefficients, chainSettings, band);
+		return;
+	}
+
+	//notch and band pass don't look at the gain, so it stays out of their key
+	const auto gainFactor = hasGain(settings.type) ? juce::Decibels::decibelsToGain(settings.gainInDecibels) : 1.f;
+	const auto type = static_cast<FilterType>(static_cast<juce::uint32>(FilterType::peak) + static_cast<juce::uint32>(settings.type));
+	const Key key{ type, 2, settings.frequency, settings.quality, gainFactor, 0, coefficients.sampleRate };
+
+	Sections sections;
+
+	getSections(key, sections, [&](Sections& designed)
+	{
+		designed[0] = ::makeBandCoefficients(coefficients.sampleRate, settings.type, settings.frequency, settings.quality, gainFactor);
+	});
+
+	coefficients.bands[static_cast<size_t>(band)] = sections[0];
+	coefficients.activeBands |= 1u << band;
+}
+
+DesignCache::Statistics DesignCache::getStatistics() const noexcept
+{
+	Statistics statistics;
+	statistics.hits = hits.load(std::memory_order_relaxed);
+	statistics.misses = misses.load(std::memory_order_relaxed);
+	statistics.evictions = evictions.load(std::memory_order_relaxed);
+	return statistics;
+}
+
+template <typename Design>
+void DesignCache::getSections(const Key& key, Sections& sections, Design&& design)
+{
+	if (find(key, sections))
+	{
+		hits.fetch_add(1, std::memory_order_relaxed);
+		return;
+	}
+
+	misses.fetch_add(1, std::memory_order_relaxed);
+
+	sections = {};
+	design(sections);
+	insert(key, sections);
+}
+
+bool DesignCache::find(const Key& key, Sections& sections) noexcept
+{
+	for (auto& entry : sets[getSetIndex(key)])
+	{
+		const auto before = entry.sequence.load(std::memory_order_acquire);
+
+		if (before == 0 || (before & 1) != 0) //empty, or a writer is busy with it
+			continue;
+
+		std::array<juce::uint32, numWords> words;
+
+		for (size_t i = 0; i < numWords; ++i)
+			words[i] = entry.words[i].load(std::memory_order_relaxed);
+
+		std::atomic_thread_fence(std::memory_order_acquire);
+
+		if (entry.sequence.load(std::memory_order_relaxed) != before)
+			continue;
+
+		Payload payload;
+		std::memcpy(static_cast<void*>(&payload), words.data(), sizeof(Payload));
+
+		if (payload.key == key)
+		{
+			entry.lastUsed.store(useClock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+			sections = payload.sections;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+void DesignCache::insert(const Key& key, const Sections& sections) noexcept
+{
+	auto& set = sets[getSetIndex(key)];
+
+	//an empty entry if there is one, otherwise the one that went unused the longest. The
+	//ages are unsigned differences, so they stay right when the clock wraps around
+	const auto now = useClock.load(std::memory_order_relaxed);
+	Entry* victim = &set[0];
+
+	for (auto& entry : set)
+	{
+		if (entry.sequence.load(std::memory_order_relaxed) == 0)
+		{
+			victim = &entry;
+			break;
+		}
+
+		if (now - entry.lastUsed.load(std::memory_order_relaxed) > now - victim->lastUsed.load(std::memory_order_relaxed))
+			victim = &entry;
+	}
+
+	auto sequence = victim->sequence.load(std::memory_order_relaxed);
+
+	//another thread is writing this entry, the design is just not cached this time
+	if ((sequence & 1) != 0 || !victim->sequence.compare_exchange_strong(sequence, sequence + 1, std::memory_order_relaxed))
+		return;
+
+	std::atomic_thread_fence(std::memory_order_release); //readers that see any of the new words also see the odd sequence
+
+	if (sequence != 0)
+		evictions.fetch_add(1, std::memory_order_relaxed);
+
+	Payload payload{ key, sections };
+	std::array<juce::uint32, numWords> words;
+	std::memcpy(words.data(), &payload, sizeof(Payload));
+
+	for (size_t i = 0; i < numWords; ++i)
+		victim->words[i].store(words[i], std::memory_order_relaxed);
+
+	victim->lastUsed.store(useClock.fetch_add(1, std::memory_order_relaxed), std::memory_order_relaxed);
+	victim->sequence.store(sequence + 2, std::memory_order_release);
+}
+
+size_t DesignCache::getSetIndex(const Key& key) noexcept
+{
+	//FNV-1a over the key bytes, the parameters only move in small steps so every bit has to count
+	std::array<juce::uint8, sizeof(Key)> bytes;
+	std::memcpy(bytes.data(), &key, sizeof(Key));
+
+	juce::uint32 hash = 2166136261u;
+
+	for (auto byte : bytes)
+		hash = (hash ^ byte) * 16777619u;
+
+	return static_cast<size_t>(hash) % numSets;
+}
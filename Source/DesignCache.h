@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    Process wide cache of finished band designs, shared by every plugin
+    instance through a SharedResourcePointer. Big templates run hundreds of
+    instances with the same 80 Hz low cut, this way the sections are worked
+    out once and every other instance copies them.
+
+    The table is set associative with a fixed number of entries, so memory
+    stays bounded, and the least recently used entry of a set makes way for
+    a new design. Every entry is guarded by a sequence counter: readers copy
+    it and check the counter didn't move, writers claim it with a single
+    compare and swap and simply skip caching when another thread got there
+    first. Nobody ever waits.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "FilterCoefficients.h"
+
+class DesignCache
+{
+public:
+	static constexpr int numSets = 512;
+	static constexpr int numWays = 4;		//entries per set, 2048 in total, about 240 kB
+
+	struct Statistics
+	{
+		juce::uint64 hits{ 0 }, misses{ 0 }, evictions{ 0 };
+	};
+
+	DesignCache() = default;
+
+	//any thread but the audio thread. Same results as the functions in FilterCoefficients.h,
+	//designed on a miss and served from the cache on a hit
+	void makeLowCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings);
+	void makeHighCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings);
+	void makeBandCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band);
+
+	//any thread, counted since the cache was created
+	Statistics getStatistics() const noexcept;
+
+private:
+	using Sections = std::array<BiquadCoefficients, maxCutSections>; //a band only uses the first one
+
+	enum class FilterType : juce::uint32
+	{
+		lowCut = 1,
+		highCut,
+		peak,		//then the other band types, in BandType order
+		lowShelf,
+		highShelf,
+		notch,
+		bandPass
+	};
+
+	//only 32 bit fields before the double, so there is no padding and equal keys hash the same
+	struct Key
+	{
+		FilterType type;
+		juce::uint32 order;
+		float frequency, quality, gainFactor;
+		juce::uint32 reserved{ 0 };
+		double sampleRate;
+
+		bool operator== (const Key& other) const noexcept
+		{
+			return type == other.type && order == other.order && frequency == other.frequency && quality == other.quality
+				&& gainFactor == other.gainFactor && sampleRate == other.sampleRate;
+		}
+	};
+
+	struct Payload
+	{
+		Key key;
+		Sections sections;
+	};
+
+	static constexpr size_t numWords = sizeof(Payload) / sizeof(juce::uint32);
+	static_assert(sizeof(Payload) % sizeof(juce::uint32) == 0, "the payload is copied word by word");
+	static_assert(std::is_trivially_copyable<Payload>::value, "the payload is copied word by word");
+
+	//the payload is kept as relaxed atomic words, so a reader racing a writer sees a torn copy,
+	//which the sequence check throws away, instead of a data race
+	struct Entry
+	{
+		std::atomic<juce::uint32> sequence{ 0 };	//0 while empty, odd while being written
+		std::atomic<juce::uint32> lastUsed{ 0 };
+		std::array<std::atomic<juce::uint32>, numWords> words{};
+	};
+
+	template <typename Design>
+	void getSections(const Key& key, Sections& sections, Design&& design);
+
+	bool find(const Key& key, Sections& sections) noexcept;
+	void insert(const Key& key, const Sections& sections) noexcept;
+
+	static size_t getSetIndex(const Key& key) noexcept;
+
+	std::array<std::array<Entry, numWays>, numSets> sets;
+
+	std::atomic<juce::uint32> useClock{ 0 };
+	std::atomic<juce::uint64> hits{ 0 }, misses{ 0 }, evictions{ 0 };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DesignCache)
+};
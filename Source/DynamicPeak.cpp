@@ -0,0 +1,215 @@
+/*
+  ==============================================================================
+
+    Dynamic mode of the peak band.
+
+  ==============================================================================
+*/
+
+#include "DynamicPeak.h"
+
+void DynamicPeak::prepare(int channels, int maximumBlockSize)
+{
+	numChannels = channels;
+
+	detectors.resize(static_cast<size_t>((channels + lanes - 1) / lanes));
+	interleaved.assign(static_cast<size_t>(maximumBlockSize), Vec::expand(0.f));
+
+	reset();
+}
+
+void DynamicPeak::setSampleRate(double newSampleRate, int newControlInterval) noexcept
+{
+	sampleRate = newSampleRate;
+	controlInterval = newControlInterval;
+
+	//frequency and Q move once per step, gliding like the other coefficient changes
+	const auto stepsPerSecond = sampleRate / controlInterval;
+	frequency.reset(stepsPerSecond, 0.02);
+	quality.reset(stepsPerSecond, 0.02);
+	frequency.setCurrentAndTargetValue(settings.frequency);
+	quality.setCurrentAndTargetValue(settings.quality);
+
+	setSettings(settings);
+	updateFollower(); //the step length changed, the times didn't
+	updateDetector();
+	reset();
+}
+
+void DynamicPeak::reset() noexcept
+{
+	for (auto& detector : detectors)
+		detector.s1 = detector.s2 = Vec::expand(0.f);
+
+	envelope = floorInDecibels;
+	designedGain = 0.f;
+	peak = makeBandCoefficients(sampleRate, settings.type, designedFrequency > 0.f ? designedFrequency : settings.frequency,
+		designedQuality > 0.f ? designedQuality : settings.quality, 1.f);
+	gainInDecibels.store(0.f, std::memory_order_relaxed);
+}
+
+void DynamicPeak::setSettings(const Settings& newSettings) noexcept
+{
+	const auto typeChanged = newSettings.type != settings.type;
+
+	settings = newSettings;
+	settings.ratio = juce::jmax(1.f, settings.ratio);
+
+	frequency.setTargetValue(settings.frequency);
+	quality.setTargetValue(settings.quality);
+
+	//one pole per step, reaching 1 - 1/e of the way in the given time. Only worked out again when the times move
+	if (settings.attackMs != designedAttackMs || settings.releaseMs != designedReleaseMs)
+		updateFollower();
+
+	if (typeChanged) //redesigned on the next step whatever the gain does
+		typeMoved = true;
+}
+
+void DynamicPeak::setPlacement(StereoMode newStereoMode, BandChannel newChannel) noexcept
+{
+	if (numChannels != 2)
+		return;
+
+	//the detector's states go over into the other domain the way the chain's do, so the
+	//level doesn't jump when mid/side is switched
+	if ((newStereoMode == Stereo_MidSide) != (stereoMode == Stereo_MidSide) && !detectors.empty())
+	{
+		const auto scale = newStereoMode == Stereo_MidSide ? 0.5f : 1.f;
+
+		auto convert = [scale](Vec& state)
+		{
+			const auto a = state.get(0), b = state.get(1);
+			state.set(0, (a + b) * scale);
+			state.set(1, (a - b) * scale);
+		};
+
+		convert(detectors.front().s1);
+		convert(detectors.front().s2);
+	}
+
+	stereoMode = newStereoMode;
+	bandChannel = newStereoMode == Stereo_Linked ? Channel_Both : newChannel;
+}
+
+void DynamicPeak::updateFollower() noexcept
+{
+	designedAttackMs = settings.attackMs;
+	designedReleaseMs = settings.releaseMs;
+
+	const auto stepSeconds = controlInterval / sampleRate;
+	attackCoefficient = static_cast<float>(std::exp(-stepSeconds / (juce::jmax(0.01f, settings.attackMs) * 0.001)));
+	releaseCoefficient = static_cast<float>(std::exp(-stepSeconds / (juce::jmax(0.01f, settings.releaseMs) * 0.001)));
+}
+
+void DynamicPeak::updateDetector() noexcept
+{
+	designedFrequency = frequency.getCurrentValue();
+	designedQuality = quality.getCurrentValue();
+
+	const auto c = makeBandPassCoefficients(sampleRate, designedFrequency, designedQuality);
+
+	for (auto& detector : detectors)
+	{
+		detector.b0 = Vec::expand(c.b0);
+		detector.b2 = Vec::expand(c.b2);
+		detector.a1 = Vec::expand(c.a1);
+		detector.a2 = Vec::expand(c.a2);
+	}
+}
+
+const BiquadCoefficients& DynamicPeak::process(const juce::dsp::AudioBlock<const float>& block) noexcept
+{
+	frequency.skip(1);
+	quality.skip(1);
+
+	const auto frequencyMoved = frequency.getCurrentValue() != designedFrequency || quality.getCurrentValue() != designedQuality;
+
+	if (frequencyMoved)
+		updateDetector();
+
+	const auto level = measure(block);
+	envelope = level + (level > envelope ? attackCoefficient : releaseCoefficient) * (envelope - level);
+
+	//above the threshold the band moves like a compressor's gain would, but never past the range
+	const auto overshoot = juce::jmax(0.f, envelope - settings.thresholdInDecibels);
+	const auto amount = juce::jmin(overshoot * (1.f - 1.f / settings.ratio), std::abs(settings.rangeInDecibels));
+	const auto gain = settings.rangeInDecibels < 0.f ? -amount : amount;
+
+	//steps below a thousandth of a dB aren't worth a redesign
+	if (frequencyMoved || typeMoved || std::abs(gain - designedGain) > 0.001f)
+	{
+		typeMoved = false;
+		designedGain = gain;
+		peak = makeBandCoefficients(sampleRate, settings.type, designedFrequency, designedQuality, juce::Decibels::decibelsToGain(gain));
+		gainInDecibels.store(gain, std::memory_order_relaxed);
+	}
+
+	return peak;
+}
+
+float DynamicPeak::measure(const juce::dsp::AudioBlock<const float>& block) noexcept
+{
+	const auto numSamples = juce::jmin(static_cast<int>(block.getNumSamples()), static_cast<int>(interleaved.size()));
+	const auto channels = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()));
+	const auto zero = Vec::expand(0.f);
+
+	auto* laneData = reinterpret_cast<float*>(interleaved.data());
+	float level = 0.f;
+
+	const auto midSide = stereoMode == Stereo_MidSide && channels == 2;
+
+	for (int first = 0, group = 0; first < channels; first += lanes, ++group)
+	{
+		const auto numInGroup = juce::jmin(lanes, channels - first);
+
+		if (midSide) //encoded the same way the chain encodes it
+		{
+			const auto* left = block.getChannelPointer(0);
+			const auto* right = block.getChannelPointer(1);
+
+			for (int i = 0; i < numSamples; ++i)
+			{
+				laneData[i * lanes] = 0.5f * (left[i] + right[i]);
+				laneData[i * lanes + 1] = 0.5f * (left[i] - right[i]);
+			}
+		}
+		else
+		{
+			for (int ch = 0; ch < numInGroup; ++ch) //one channel per lane, as in the chain
+			{
+				const auto* input = block.getChannelPointer(static_cast<size_t>(first + ch));
+
+				for (int i = 0; i < numSamples; ++i)
+					laneData[i * lanes + ch] = input[i];
+			}
+		}
+
+		auto& detector = detectors[static_cast<size_t>(group)];
+		auto s1 = detector.s1, s2 = detector.s2, peakLevel = zero;
+
+		for (int i = 0; i < numSamples; ++i)
+		{
+			const auto x = interleaved[static_cast<size_t>(i)];
+			const auto y = detector.b0 * x + s1;
+
+			s1 = s2 - detector.a1 * y;
+			s2 = detector.b2 * x - detector.a2 * y;
+
+			peakLevel = Vec::max(peakLevel, Vec::max(y, zero - y));
+		}
+
+		detector.s1 = s1;
+		detector.s2 = s2;
+
+		//lanes past the last channel hold leftovers, they are filtered along but never read. A band
+		//on one side of the pair only listens to that side
+		const auto firstLane = bandChannel == Channel_Second ? 1 : 0;
+		const auto endLane = bandChannel == Channel_First ? 1 : numInGroup;
+
+		for (int lane = firstLane; lane < endLane; ++lane)
+			level = juce::jmax(level, peakLevel.get(static_cast<size_t>(lane)));
+	}
+
+	return juce::Decibels::gainToDecibels(level, floorInDecibels);
+}
@@ -0,0 +1,104 @@
+/*
+  ==============================================================================
+
+    Dynamic mode of the peak band. A band pass at the peak's frequency and Q
+    listens to the input, every channel in one lane of a SIMDRegister, and
+    an attack/release follower turns its level into the band's gain: above
+    the threshold the band moves by (1 - 1 / ratio) dB per dB, up to the
+    Peak Gain, which sets both the direction and the range.
+
+    Everything runs at a fixed control rate. The level is taken over one
+    control interval, then the follower steps once and the band's section is
+    redesigned once, so the cost is a band pass per sample plus one
+    makeBandCoefficients per interval, not a compressor's worth of work.
+
+    It hears what the band filters: in mid/side the pair is encoded on the
+    way into the lanes, and a band placed on one channel of the pair is only
+    driven by that channel.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "FilterCoefficients.h"
+
+class DynamicPeak
+{
+public:
+	using Vec = juce::dsp::SIMDRegister<float>;
+
+	static constexpr int lanes = static_cast<int>(Vec::SIMDNumElements);
+	static constexpr int hostControlInterval = 32;	//samples per step at the host rate, twice as many per oversampling step
+
+	struct Settings
+	{
+		BandType type{ Band_Peak };					//one with a gain, the shelves move like the peak does
+		float frequency{ 750.f }, quality{ 1.f };
+		float rangeInDecibels{ 0.f };				//Peak Gain, positive boosts above the threshold, negative cuts
+		float thresholdInDecibels{ -24.f };
+		float ratio{ 2.f };
+		float attackMs{ 10.f }, releaseMs{ 150.f };
+	};
+
+	void prepare(int numChannels, int maximumBlockSize);
+
+	//audio thread, whenever the chain moves to another rate. controlInterval is how many samples
+	//make up one step at that rate, so the steps per second don't depend on the oversampling
+	void setSampleRate(double sampleRate, int controlInterval) noexcept;
+
+	//clears the detector and lets the band fall back to 0 dB
+	void reset() noexcept;
+
+	//audio thread, once per block
+	void setSettings(const Settings& settings) noexcept;
+
+	//audio thread, where the chain runs the band right now. Only means something for a stereo pair
+	void setPlacement(StereoMode stereoMode, BandChannel channel) noexcept;
+
+	int getControlInterval() const noexcept { return controlInterval; }
+
+	//measures the band in this piece of input, at most getControlInterval() long, and
+	//returns the section to filter it with. Never allocates
+	const BiquadCoefficients& process(const juce::dsp::AudioBlock<const float>& block) noexcept;
+
+	//any thread, the gain the band is at right now
+	float getGainInDecibels() const noexcept { return gainInDecibels.load(std::memory_order_relaxed); }
+
+private:
+	static constexpr float floorInDecibels = -120.f;
+
+	struct Detector //one band pass for up to `lanes` channels, transposed direct form II
+	{
+		Vec b0, b2, a1, a2;		//a band pass has b1 == 0
+		Vec s1, s2;
+	};
+
+	void updateFollower() noexcept;
+	void updateDetector() noexcept;
+	float measure(const juce::dsp::AudioBlock<const float>& block) noexcept;
+
+	Settings settings;
+	double sampleRate{ 44100.0 };
+	int controlInterval{ 32 };
+
+	std::vector<Detector> detectors;	//channel c is lane c % lanes of detectors[c / lanes]
+	std::vector<Vec> interleaved;
+	int numChannels{ 0 };
+
+	StereoMode stereoMode{ Stereo_Linked };
+	BandChannel bandChannel{ Channel_Both };
+
+	juce::SmoothedValue<float, juce::ValueSmoothingTypes::Multiplicative> frequency{ 750.f };
+	juce::SmoothedValue<float> quality{ 1.f };
+	float designedFrequency{ 0.f }, designedQuality{ 0.f }, designedGain{ 0.f };
+	bool typeMoved{ false };
+
+	float envelope{ floorInDecibels };
+	float attackCoefficient{ 0.f }, releaseCoefficient{ 0.f };
+	float designedAttackMs{ -1.f }, designedReleaseMs{ -1.f };	//what the coefficients were worked out for
+
+	BiquadCoefficients peak;
+	std::atomic<float> gainInDecibels{ 0.f };
+};
@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    The equalizer for any number of channels.
+
+  ==============================================================================
+*/
+
+#include "EqualizerChain.h"
+
+void EqualizerChain::prepare(int channels, int maximumBlockSize)
+{
+	numChannels = channels;
+
+	const auto numEngines = (channels + BiquadEngine::maxChannels - 1) / BiquadEngine::maxChannels;
+	engines.resize(static_cast<size_t>(numEngines));
+
+	for (int i = 0; i < numEngines; ++i)
+		engines[i].prepare(juce::jmin(BiquadEngine::maxChannels, channels - i * BiquadEngine::maxChannels), maximumBlockSize, channels == 2);
+}
+
+void EqualizerChain::reset()
+{
+	for (auto& engine : engines)
+		engine.reset();
+}
+
+void EqualizerChain::copyFrom(const EqualizerChain& other) noexcept
+{
+	jassert(other.engines.size() == engines.size());
+
+	for (size_t i = 0; i < juce::jmin(engines.size(), other.engines.size()); ++i)
+		engines[i].copyFrom(other.engines[i]);
+}
+
+void EqualizerChain::setCoefficients(const ChainCoefficients& chainCoefficients)
+{
+	for (auto& engine : engines)
+		engine.setCoefficients(chainCoefficients);
+}
+
+void EqualizerChain::rampTo(const ChainCoefficients& chainCoefficients, int numSamples)
+{
+	for (auto& engine : engines)
+		engine.rampTo(chainCoefficients, numSamples);
+}
+
+bool EqualizerChain::isRamping() const noexcept
+{
+	//the engines always ramp together
+	return !engines.empty() && engines.front().isRamping();
+}
+
+void EqualizerChain::finishRamp() noexcept
+{
+	for (auto& engine : engines)
+		engine.finishRamp();
+}
+
+void EqualizerChain::setBandCoefficients(int band, const BiquadCoefficients& coefficients) noexcept
+{
+	for (auto& engine : engines)
+		engine.setBandCoefficients(band, coefficients);
+}
+
+void EqualizerChain::releaseBand(int band, int numSamples)
+{
+	for (auto& engine : engines)
+		engine.releaseBand(band, numSamples);
+}
+
+void EqualizerChain::process(const juce::dsp::AudioBlock<float>& block)
+{
+	const auto channels = juce::jmin(numChannels, static_cast<int>(block.getNumChannels()));
+
+	for (int first = 0, i = 0; first < channels; first += BiquadEngine::maxChannels, ++i)
+	{
+		const auto numInGroup = juce::jmin(BiquadEngine::maxChannels, channels - first);
+		engines[i].process(block.getSubsetChannelBlock(static_cast<size_t>(first), static_cast<size_t>(numInGroup)));
+	}
+}
@@ -0,0 +1,47 @@
+/*
+  ==============================================================================
+
+    The equalizer for any number of channels: a pool of BiquadEngines sized
+    in prepare(), each one filtering as many channels as fit into one SIMD
+    register.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "BiquadEngine.h"
+
+class EqualizerChain
+{
+public:
+	//allocates the whole pool, nothing is allocated after this
+	void prepare(int numChannels, int maximumBlockSize);
+	void reset();
+
+	//both chains must have been prepared for the same channel count
+	void copyFrom(const EqualizerChain& other) noexcept;
+
+	//see BiquadEngine, every engine gets the same calls
+	void setCoefficients(const ChainCoefficients& chainCoefficients);
+	void rampTo(const ChainCoefficients& chainCoefficients, int numSamples);
+	bool isRamping() const noexcept;
+	void finishRamp() noexcept;
+
+	void setBandCoefficients(int band, const BiquadCoefficients& coefficients) noexcept;
+	void releaseBand(int band, int numSamples);
+
+	//filters the block in place, channels beyond the prepared count are left untouched
+	void process(const juce::dsp::AudioBlock<float>& block);
+
+	int getNumChannels() const noexcept { return numChannels; }
+
+	//the stereo pair is always the first engine, every other one runs linked
+	StereoMode getStereoMode() const noexcept { return engines.empty() ? Stereo_Linked : engines.front().getStereoMode(); }
+	BandChannel getBandChannel(int band) const noexcept { return engines.empty() ? Channel_Both : engines.front().getBandChannel(band); }
+
+private:
+	std::vector<BiquadEngine> engines; //engine g handles channels [g * maxChannels, (g + 1) * maxChannels)
+	int numChannels{ 0 };
+};
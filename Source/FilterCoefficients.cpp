@@ -0,0 +1,380 @@
+/*
+  ==============================================================================
+
+    Plain coefficient sets for the equalizer chain and the functions that
+    design them.
+
+  ==============================================================================
+*/
+
+#include "FilterCoefficients.h"
+
+namespace
+{
+	BiquadCoefficients normalise(double b0, double b1, double b2, double a0, double a1, double a2)
+	{
+		const auto a0Inv = 1.0 / a0;
+
+		BiquadCoefficients c;
+		c.b0 = static_cast<float>(b0 * a0Inv);
+		c.b1 = static_cast<float>(b1 * a0Inv);
+		c.b2 = static_cast<float>(b2 * a0Inv);
+		c.a1 = static_cast<float>(a1 * a0Inv);
+		c.a2 = static_cast<float>(a2 * a0Inv);
+		return c;
+	}
+
+	//the parameters go up to 20 kHz, which is above nyquist for 32 kHz sessions
+	double limitFrequency(double sampleRate, float frequency)
+	{
+		return juce::jlimit(2.0, sampleRate * 0.499, static_cast<double>(frequency));
+	}
+
+	//|H|^2 of one biquad written in cos(w) and cos(2w), so no complex maths is needed. In double,
+	//near a resonance the terms nearly cancel and float products lose the result
+	void multiplySquaredMagnitudes(const BiquadCoefficients& c, const double* cosW, const double* cos2W,
+		double* squared, int numPoints)
+	{
+		const double b0 = c.b0, b1 = c.b1, b2 = c.b2, a1 = c.a1, a2 = c.a2;
+
+		const auto n0 = b0 * b0 + b1 * b1 + b2 * b2, n1 = 2.0 * (b0 * b1 + b1 * b2), n2 = 2.0 * b0 * b2;
+		const auto d0 = 1.0 + a1 * a1 + a2 * a2, d1 = 2.0 * (a1 + a1 * a2), d2 = 2.0 * a2;
+
+		for (int i = 0; i < numPoints; ++i)
+			squared[i] *= (n0 + n1 * cosW[i] + n2 * cos2W[i]) / (d0 + d1 * cosW[i] + d2 * cos2W[i]);
+	}
+
+	//a section that is rounded onto or past the unit circle would ring forever, the tail is capped at this
+	constexpr double maxTailSeconds = 10.0;
+
+	//samples until the slower of a biquad's two poles has decayed by exp(logDecay). The poles are the roots
+	//of z^2 + a1 z + a2, a complex pair has radius sqrt(a2), otherwise the larger real root is the slow one
+	double getDecaySamples(const BiquadCoefficients& c, double logDecay, double maxSamples)
+	{
+		const double a1 = c.a1, a2 = c.a2;
+		const auto discriminant = a1 * a1 - 4.0 * a2;
+		const auto radius = discriminant < 0.0 ? std::sqrt(a2) : 0.5 * (std::abs(a1) + std::sqrt(discriminant));
+
+		if (radius <= 0.0) //pass through or FIR, done after two samples
+			return 2.0;
+
+		if (radius >= 1.0)
+			return maxSamples;
+
+		return juce::jmin(maxSamples, logDecay / std::log(radius));
+	}
+
+	//Q of section i of an even order Butterworth cascade
+	double butterworthQuality(int section, int order)
+	{
+		return 1.0 / (2.0 * std::cos((section + 0.5) * juce::MathConstants<double>::pi / order));
+	}
+}
+
+BiquadCoefficients makePeakCoefficients(double sampleRate, float frequency, float quality, float gainFactor)
+{
+	const auto A = juce::jmax(0.0, std::sqrt(static_cast<double>(gainFactor)));
+	const auto omega = juce::MathConstants<double>::twoPi * limitFrequency(sampleRate, frequency) / sampleRate;
+	const auto alpha = std::sin(omega) / (quality * 2.0);
+	const auto c2 = -2.0 * std::cos(omega);
+	const auto alphaTimesA = alpha * A;
+	const auto alphaOverA = alpha / A;
+
+	return normalise(1.0 + alphaTimesA, c2, 1.0 - alphaTimesA, 1.0 + alphaOverA, c2, 1.0 - alphaOverA);
+}
+
+BiquadCoefficients makeBandPassCoefficients(double sampleRate, float frequency, float quality)
+{
+	const auto omega = juce::MathConstants<double>::twoPi * limitFrequency(sampleRate, frequency) / sampleRate;
+	const auto alpha = std::sin(omega) / (quality * 2.0);
+
+	return normalise(alpha, 0.0, -alpha, 1.0 + alpha, -2.0 * std::cos(omega), 1.0 - alpha);
+}
+
+BiquadCoefficients makeLowShelfCoefficients(double sampleRate, float frequency, float quality, float gainFactor)
+{
+	const auto A = juce::jmax(0.0, std::sqrt(static_cast<double>(gainFactor)));
+	const auto aMinus1 = A - 1.0, aPlus1 = A + 1.0;
+	const auto omega = juce::MathConstants<double>::twoPi * limitFrequency(sampleRate, frequency) / sampleRate;
+	const auto coso = std::cos(omega);
+	const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+	const auto aMinus1TimesCoso = aMinus1 * coso;
+
+	return normalise(A * (aPlus1 - aMinus1TimesCoso + beta),
+		A * 2.0 * (aMinus1 - aPlus1 * coso),
+		A * (aPlus1 - aMinus1TimesCoso - beta),
+		aPlus1 + aMinus1TimesCoso + beta,
+		-2.0 * (aMinus1 + aPlus1 * coso),
+		aPlus1 + aMinus1TimesCoso - beta);
+}
+
+BiquadCoefficients makeHighShelfCoefficients(double sampleRate, float frequency, float quality, float gainFactor)
+{
+	const auto A = juce::jmax(0.0, std::sqrt(static_cast<double>(gainFactor)));
+	const auto aMinus1 = A - 1.0, aPlus1 = A + 1.0;
+	const auto omega = juce::MathConstants<double>::twoPi * limitFrequency(sampleRate, frequency) / sampleRate;
+	const auto coso = std::cos(omega);
+	const auto beta = std::sin(omega) * std::sqrt(A) / quality;
+	const auto aMinus1TimesCoso = aMinus1 * coso;
+
+	return normalise(A * (aPlus1 + aMinus1TimesCoso + beta),
+		A * -2.0 * (aMinus1 + aPlus1 * coso),
+		A * (aPlus1 + aMinus1TimesCoso - beta),
+		aPlus1 - aMinus1TimesCoso + beta,
+		2.0 * (aMinus1 - aPlus1 * coso),
+		aPlus1 - aMinus1TimesCoso - beta);
+}
+
+BiquadCoefficients makeNotchCoefficients(double sampleRate, float frequency, float quality)
+{
+	const auto omega = juce::MathConstants<double>::twoPi * limitFrequency(sampleRate, frequency) / sampleRate;
+	const auto alpha = std::sin(omega) / (quality * 2.0);
+	const auto c2 = -2.0 * std::cos(omega);
+
+	return normalise(1.0, c2, 1.0, 1.0 + alpha, c2, 1.0 - alpha);
+}
+
+BiquadCoefficients makeBandCoefficients(double sampleRate, BandType type, float frequency, float quality, float gainFactor)
+{
+	switch (type)
+	{
+		case Band_LowShelf:		return makeLowShelfCoefficients(sampleRate, frequency, quality, gainFactor);
+		case Band_HighShelf:	return makeHighShelfCoefficients(sampleRate, frequency, quality, gainFactor);
+		case Band_Notch:		return makeNotchCoefficients(sampleRate, frequency, quality);
+		case Band_BandPass:		return makeBandPassCoefficients(sampleRate, frequency, quality);
+		case Band_Peak:
+		default:				return makePeakCoefficients(sampleRate, frequency, quality, gainFactor);
+	}
+}
+
+bool isBandActive(const BandSettings& band) noexcept
+{
+	return band.enabled && (!hasGain(band.type) || band.gainInDecibels != 0.f);
+}
+
+void makeLowCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope)
+{
+	std::array<PreciseBiquadCoefficients, maxCutSections> precise;
+	makeLowCutCoefficients(precise, sampleRate, frequency, slope);
+
+	for (int i = 0; i < maxCutSections; ++i)
+		sections[i] = toFloat(precise[i]);
+}
+
+void makeHighCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope)
+{
+	std::array<PreciseBiquadCoefficients, maxCutSections> precise;
+	makeHighCutCoefficients(precise, sampleRate, frequency, slope);
+
+	for (int i = 0; i < maxCutSections; ++i)
+		sections[i] = toFloat(precise[i]);
+}
+
+void makeLowCutCoefficients(std::array<PreciseBiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope)
+{
+	const auto order = 2 * (slope + 1);
+	const auto n = std::tan(juce::MathConstants<double>::pi * limitFrequency(sampleRate, frequency) / sampleRate);
+	const auto nSquared = n * n;
+
+	for (int i = 0; i <= slope; ++i) //highpass sections
+	{
+		const auto invQ = 1.0 / butterworthQuality(i, order);
+		const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+		sections[i] = { c1, c1 * -2.0, c1, c1 * 2.0 * (nSquared - 1.0), c1 * (1.0 - invQ * n + nSquared) }; //a0 is 1 already
+	}
+
+	for (int i = slope + 1; i < maxCutSections; ++i)
+		sections[i] = {};
+}
+
+void makeHighCutCoefficients(std::array<PreciseBiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope)
+{
+	const auto order = 2 * (slope + 1);
+	const auto n = 1.0 / std::tan(juce::MathConstants<double>::pi * limitFrequency(sampleRate, frequency) / sampleRate);
+	const auto nSquared = n * n;
+
+	for (int i = 0; i <= slope; ++i) //lowpass sections
+	{
+		const auto invQ = 1.0 / butterworthQuality(i, order);
+		const auto c1 = 1.0 / (1.0 + invQ * n + nSquared);
+
+		sections[i] = { c1, c1 * 2.0, c1, c1 * 2.0 * (1.0 - nSquared), c1 * (1.0 - invQ * n + nSquared) };
+	}
+
+	for (int i = slope + 1; i < maxCutSections; ++i)
+		sections[i] = {};
+}
+
+void makeBandCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band)
+{
+	const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+	const auto bit = 1u << band;
+
+	if (!isBandActive(settings))
+	{
+		coefficients.bands[static_cast<size_t>(band)] = {};
+		coefficients.activeBands &= ~bit;
+		return;
+	}
+
+	coefficients.bands[static_cast<size_t>(band)] = makeBandCoefficients(coefficients.sampleRate,
+		settings.type,
+		settings.frequency,
+		settings.quality,
+		juce::Decibels::decibelsToGain(settings.gainInDecibels));
+
+	coefficients.activeBands |= bit;
+}
+
+void makeLowCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings)
+{
+	makeLowCutCoefficients(coefficients.lowCut, coefficients.sampleRate, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+	coefficients.lowCutSlope = chainSettings.lowCutSlope;
+}
+
+void makeHighCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings)
+{
+	makeHighCutCoefficients(coefficients.highCut, coefficients.sampleRate, chainSettings.highCutFreq, chainSettings.highCutSlope);
+	coefficients.highCutSlope = chainSettings.highCutSlope;
+}
+
+BiquadCoefficients interpolate(const BiquadCoefficients& a, const BiquadCoefficients& b, float amount)
+{
+	BiquadCoefficients c;
+	c.b0 = a.b0 + amount * (b.b0 - a.b0);
+	c.b1 = a.b1 + amount * (b.b1 - a.b1);
+	c.b2 = a.b2 + amount * (b.b2 - a.b2);
+	c.a1 = a.a1 + amount * (b.a1 - a.a1);
+	c.a2 = a.a2 + amount * (b.a2 - a.a2);
+	return c;
+}
+
+PreciseBiquadCoefficients interpolate(const PreciseBiquadCoefficients& a, const PreciseBiquadCoefficients& b, double amount)
+{
+	PreciseBiquadCoefficients c;
+	c.b0 = a.b0 + amount * (b.b0 - a.b0);
+	c.b1 = a.b1 + amount * (b.b1 - a.b1);
+	c.b2 = a.b2 + amount * (b.b2 - a.b2);
+	c.a1 = a.a1 + amount * (b.a1 - a.a1);
+	c.a2 = a.a2 + amount * (b.a2 - a.a2);
+	return c;
+}
+
+BiquadCoefficients toFloat(const PreciseBiquadCoefficients& coefficients)
+{
+	return normalise(coefficients.b0, coefficients.b1, coefficients.b2, 1.0, coefficients.a1, coefficients.a2);
+}
+
+void interpolate(ChainCoefficients& result, const ChainCoefficients& a, const ChainCoefficients& b, float amount)
+{
+	for (int i = 0; i < maxCutSections; ++i)
+	{
+		result.lowCut[i] = interpolate(a.lowCut[i], b.lowCut[i], amount);
+		result.highCut[i] = interpolate(a.highCut[i], b.highCut[i], amount);
+		result.secondLowCut[i] = interpolate(a.secondLowCut[i], b.secondLowCut[i], amount);
+		result.secondHighCut[i] = interpolate(a.secondHighCut[i], b.secondHighCut[i], amount);
+	}
+
+	for (int i = 0; i < maxBands; ++i)
+	{
+		result.bands[i] = interpolate(a.bands[i], b.bands[i], amount);
+		result.secondBands[i] = interpolate(a.secondBands[i], b.secondBands[i], amount);
+	}
+
+	//while fading, every section that is active on either side has to run
+	result.lowCutSlope = juce::jmax(a.lowCutSlope, b.lowCutSlope);
+	result.highCutSlope = juce::jmax(a.highCutSlope, b.highCutSlope);
+	result.activeBands = a.activeBands | b.activeBands;
+	result.stereoMode = b.stereoMode;
+	result.bandChannels = b.bandChannels;
+	result.sampleRate = b.sampleRate;
+}
+
+void applyStereoMode(ChainCoefficients& coefficients, const ChainSettings& chainSettings)
+{
+	coefficients.stereoMode = chainSettings.stereoMode;
+
+	const auto linked = chainSettings.stereoMode == Stereo_Linked;
+
+	//the section stays with the channels it's placed on, the other one passes through
+	auto split = [linked](BiquadCoefficients& first, BiquadCoefficients& second, BandChannel channel)
+	{
+		second = first;
+
+		if (linked || channel == Channel_Both)
+			return;
+
+		if (channel == Channel_First)
+			second = {};
+		else
+			first = {};
+	};
+
+	for (int i = 0; i < maxCutSections; ++i)
+	{
+		split(coefficients.lowCut[i], coefficients.secondLowCut[i], chainSettings.lowCutChannel);
+		split(coefficients.highCut[i], coefficients.secondHighCut[i], chainSettings.highCutChannel);
+	}
+
+	for (int i = 0; i < maxBands; ++i)
+	{
+		const auto channel = linked ? Channel_Both : chainSettings.bands[i].channel;
+
+		split(coefficients.bands[i], coefficients.secondBands[i], channel);
+		coefficients.bandChannels[i] = channel;
+	}
+}
+
+double getMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency)
+{
+	const auto omega = juce::MathConstants<double>::twoPi * frequency / chainCoefficients.sampleRate;
+	const auto cosW = std::cos(omega);
+	const auto cos2W = std::cos(2.0 * omega);
+
+	double magnitude;
+	getMagnitudesForGrid(chainCoefficients, &cosW, &cos2W, &magnitude, 1);
+	return magnitude;
+}
+
+void getMagnitudesForGrid(const ChainCoefficients& chainCoefficients, const double* cosW, const double* cos2W,
+	double* magnitudes, int numPoints)
+{
+	std::fill(magnitudes, magnitudes + numPoints, 1.0);
+
+	for (int i = 0; i < maxBands; ++i)
+		if (chainCoefficients.isBandActive(i))
+			multiplySquaredMagnitudes(chainCoefficients.bands[i], cosW, cos2W, magnitudes, numPoints);
+
+	for (int i = 0; i <= chainCoefficients.lowCutSlope; ++i)
+		multiplySquaredMagnitudes(chainCoefficients.lowCut[i], cosW, cos2W, magnitudes, numPoints);
+
+	for (int i = 0; i <= chainCoefficients.highCutSlope; ++i)
+		multiplySquaredMagnitudes(chainCoefficients.highCut[i], cosW, cos2W, magnitudes, numPoints);
+
+	for (int i = 0; i < numPoints; ++i)
+		magnitudes[i] = std::sqrt(magnitudes[i]);
+}
+
+double getDecayTimeSeconds(const ChainCoefficients& chainCoefficients, double decayDecibels)
+{
+	if (chainCoefficients.sampleRate <= 0.0)
+		return 0.0;
+
+	const auto logDecay = -decayDecibels / 20.0 * std::log(10.0);
+	const auto maxSamples = maxTailSeconds * chainCoefficients.sampleRate;
+
+	auto samples = 0.0;
+
+	for (int i = 0; i < maxBands; ++i)
+		if (chainCoefficients.isBandActive(i))
+			samples = juce::jmax(samples, getDecaySamples(chainCoefficients.bands[i], logDecay, maxSamples));
+
+	for (int i = 0; i <= chainCoefficients.lowCutSlope; ++i)
+		samples = juce::jmax(samples, getDecaySamples(chainCoefficients.lowCut[i], logDecay, maxSamples));
+
+	for (int i = 0; i <= chainCoefficients.highCutSlope; ++i)
+		samples = juce::jmax(samples, getDecaySamples(chainCoefficients.highCut[i], logDecay, maxSamples));
+
+	return juce::jmin(maxTailSeconds, samples / chainCoefficients.sampleRate);
+}
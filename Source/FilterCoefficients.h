@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    Plain coefficient sets for the equalizer chain and the functions that
+    design them. Nothing in here allocates, so a finished set can be copied
+    around between threads like any other value.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+
+struct BiquadCoefficients //normalised so that a0 == 1, the defaults pass the signal through untouched
+{
+	float b0{ 1.f }, b1{ 0.f }, b2{ 0.f }, a1{ 0.f }, a2{ 0.f };
+};
+
+//the same in double, before the rounding. Near DC at the oversampled rates a1 and a2 sit so close to -2
+//and 1 that float keeps only a few bits of what matters, so anything blending designs does it in here
+struct PreciseBiquadCoefficients
+{
+	double b0{ 1.0 }, b1{ 0.0 }, b2{ 0.0 }, a1{ 0.0 }, a2{ 0.0 };
+};
+
+static constexpr int maxCutSections = 4; //Slope_48 is an 8th order Butterworth, so 4 biquads
+
+struct ChainCoefficients //everything the MonoChain needs for one set of parameters
+{
+	std::array<BiquadCoefficients, maxCutSections> lowCut, highCut;
+	std::array<BiquadCoefficients, maxBands> bands;	//pass through while inactive
+
+	//what the second channel of a stereo pair runs, right or side. Only filled in by applyStereoMode,
+	//before that, and in the linked mode, both channels run the sections above
+	std::array<BiquadCoefficients, maxCutSections> secondLowCut, secondHighCut;
+	std::array<BiquadCoefficients, maxBands> secondBands;
+
+	Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
+	juce::uint32 activeBands{ 0 };						//bit i set when bands[i] has to run
+
+	StereoMode stereoMode{ Stereo_Linked };
+	std::array<BandChannel, maxBands> bandChannels{};	//for the dynamic mode, which redesigns a band on the audio thread
+
+	bool isBandActive(int band) const noexcept { return (activeBands >> band) & 1u; }
+
+	double sampleRate{ 0.0 };
+};
+
+//same formulas as juce::dsp::IIR::Coefficients::makePeakFilter, without the heap allocated result
+BiquadCoefficients makePeakCoefficients(double sampleRate, float frequency, float quality, float gainFactor);
+
+//band pass with 0 dB at the centre (the cookbook constant peak gain version), used to listen to one band
+BiquadCoefficients makeBandPassCoefficients(double sampleRate, float frequency, float quality);
+
+//same formulas as juce::dsp::IIR::Coefficients::makeLowShelf / makeHighShelf / makeNotch
+BiquadCoefficients makeLowShelfCoefficients(double sampleRate, float frequency, float quality, float gainFactor);
+BiquadCoefficients makeHighShelfCoefficients(double sampleRate, float frequency, float quality, float gainFactor);
+BiquadCoefficients makeNotchCoefficients(double sampleRate, float frequency, float quality);
+
+//any of the band types, notch and band pass ignore the gain
+BiquadCoefficients makeBandCoefficients(double sampleRate, BandType type, float frequency, float quality, float gainFactor);
+
+//a disabled band, or a peak or shelf at 0 dB, leaves the signal alone and is left out of the chain
+bool isBandActive(const BandSettings& band) noexcept;
+
+inline bool hasGain(BandType type) noexcept { return type == Band_Peak || type == Band_LowShelf || type == Band_HighShelf; }
+
+//same section layout as juce::dsp::FilterDesign::designIIR*HighOrderButterworthMethod for even orders,
+//the sections are written into the first (slope + 1) entries of the array, the rest are set to pass through
+void makeLowCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope);
+void makeHighCutCoefficients(std::array<BiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope);
+
+void makeLowCutCoefficients(std::array<PreciseBiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope);
+void makeHighCutCoefficients(std::array<PreciseBiquadCoefficients, maxCutSections>& sections, double sampleRate, float frequency, Slope slope);
+
+BiquadCoefficients toFloat(const PreciseBiquadCoefficients& coefficients);
+
+//designs one band and updates its bit in activeBands
+void makeBandCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings, int band);
+void makeLowCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings);
+void makeHighCutCoefficients(ChainCoefficients& coefficients, const ChainSettings& chainSettings);
+
+//blends two designs, amount 0 gives a and 1 gives b. Every stable biquad has its (a1, a2) inside the same
+//triangle and that triangle is convex, so anything in between two stable designs is stable as well
+BiquadCoefficients interpolate(const BiquadCoefficients& a, const BiquadCoefficients& b, float amount);
+PreciseBiquadCoefficients interpolate(const PreciseBiquadCoefficients& a, const PreciseBiquadCoefficients& b, double amount);
+
+//unused cut sections and inactive bands are pass through, so a slope change or a band
+//switching on or off simply fades sections in or out
+void interpolate(ChainCoefficients& result, const ChainCoefficients& a, const ChainCoefficients& b, float amount);
+
+//splits the sections between the two channels of a stereo pair, following where each band and cut is
+//placed. In the linked mode both get everything. The unsplit design is what the response curve, the
+//linear phase kernel and the tail estimate look at, they cover every band on every channel
+void applyStereoMode(ChainCoefficients& coefficients, const ChainSettings& chainSettings);
+
+//linear magnitude of the active sections at the given frequency, used wherever the response is needed outside the audio path
+double getMagnitudeForFrequency(const ChainCoefficients& chainCoefficients, double frequency);
+
+//the same for a whole grid of frequencies at once, given cos(w) and cos(2w) for each point. The work is
+//plain loops over contiguous arrays, one per section, which the compiler turns into SIMD code
+void getMagnitudesForGrid(const ChainCoefficients& chainCoefficients, const double* cosW, const double* cos2W,
+	double* magnitudes, int numPoints);
+
+//how long the impulse response of the active sections takes to fall by decayDecibels, worked out from the slowest
+//pole in the chain. The other sections have died away by then, and the Butterworth poles are all distinct, so
+//this stays on the safe side of the measured response
+double getDecayTimeSeconds(const ChainCoefficients& chainCoefficients, double decayDecibels);
@@ -0,0 +1,190 @@
+/*
+  ==============================================================================
+
+    Linear phase alternative to the IIR chain.
+
+  ==============================================================================
+*/
+
+#include "LinearPhaseEqualizer.h"
+
+LinearPhaseEqualizer::~LinearPhaseEqualizer()
+{
+	release();
+}
+
+void LinearPhaseEqualizer::prepare(double newSampleRate, int maximumBlockSize, int numChannels)
+{
+	release();
+
+	sampleRate = newSampleRate;
+	blockSize = maximumBlockSize;
+	channels = numChannels;
+
+	//roughly 170 ms of kernel, enough for the 48 dB/Oct cut at 20 Hz to settle
+	const auto fftOrder = newSampleRate <= 50000.0 ? 13 : (newSampleRate <= 100000.0 ? 14 : 15);
+	kernelSize = 1 << fftOrder;
+
+	fft = std::make_unique<juce::dsp::FFT>(fftOrder);
+	fftData.assign(static_cast<size_t>(kernelSize) * 2, 0.f);
+
+	window.assign(static_cast<size_t>(kernelSize), 0.f);
+	juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), static_cast<size_t>(kernelSize),
+		juce::dsp::WindowingFunction<float>::blackman, false);
+
+	convolutions.clear();
+
+	for (int first = 0; first < numChannels; first += 2)
+	{
+		juce::dsp::ProcessSpec spec;
+		spec.sampleRate = newSampleRate;
+		spec.maximumBlockSize = static_cast<juce::uint32>(maximumBlockSize);
+		spec.numChannels = static_cast<juce::uint32>(juce::jmin(2, numChannels - first));
+
+		auto convolution = std::make_unique<juce::dsp::Convolution>(loadingQueue);
+		convolution->prepare(spec);
+		convolutions.push_back(std::move(convolution));
+	}
+
+	samplesHeard = 0;
+	ready = false;
+
+	designerThread->addTimeSliceClient(this);
+}
+
+void LinearPhaseEqualizer::release()
+{
+	designerThread->removeTimeSliceClient(this);
+}
+
+void LinearPhaseEqualizer::setTarget(const ChainCoefficients& chainCoefficients)
+{
+	const juce::ScopedLock sl(targetLock);
+
+	target = chainCoefficients;
+	targetChanged = true;
+}
+
+bool LinearPhaseEqualizer::loadNow()
+{
+	designerThread->removeTimeSliceClient(this); //waits for a kernel it may be building, the target is left to us
+
+	ChainCoefficients chainCoefficients;
+	bool build = false;
+
+	{
+		const juce::ScopedLock sl(targetLock);
+
+		build = targetChanged;
+		chainCoefficients = target;
+		targetChanged = false;
+	}
+
+	if (build)
+		buildAndLoadKernel(chainCoefficients);
+
+	designerThread->addTimeSliceClient(this);
+
+	//the kernel only goes in while the convolutions process. Silence is what a render starts from,
+	//so what they hold afterwards is exactly right for the first block
+	juce::AudioBuffer<float> silence(juce::jmax(1, channels), juce::jmax(1, blockSize));
+	const auto deadline = juce::Time::getMillisecondCounterHiRes() + loadTimeoutMs;
+
+	while (!isReady())
+	{
+		if (juce::Time::getMillisecondCounterHiRes() > deadline)
+			return false;
+
+		silence.clear();
+		juce::dsp::AudioBlock<float> block(silence);
+		process(block);
+
+		if (samplesHeard == 0) //still being loaded on the convolutions' thread
+			juce::Thread::sleep(1);
+	}
+
+	return true;
+}
+
+int LinearPhaseEqualizer::useTimeSlice()
+{
+	ChainCoefficients chainCoefficients;
+
+	{
+		const juce::ScopedLock sl(targetLock);
+
+		if (!targetChanged)
+			return rebuildIntervalMs;
+
+		chainCoefficients = target;
+		targetChanged = false;
+	}
+
+	buildAndLoadKernel(chainCoefficients);
+	return rebuildIntervalMs;
+}
+
+void LinearPhaseEqualizer::buildAndLoadKernel(const ChainCoefficients& chainCoefficients)
+{
+	//zero phase spectrum holding only the magnitude of the IIR design. The set may have been
+	//designed for an oversampled rate, its response is simply read at the bins of this rate
+	std::fill(fftData.begin(), fftData.end(), 0.f);
+
+	for (int bin = 0; bin <= kernelSize / 2; ++bin)
+	{
+		const auto frequency = bin * sampleRate / kernelSize;
+		fftData[static_cast<size_t>(bin) * 2] = static_cast<float>(getMagnitudeForFrequency(chainCoefficients, frequency));
+	}
+
+	fft->performRealOnlyInverseTransform(fftData.data());
+
+	//the zero phase impulse is centred on sample 0, rotate it to the middle and window it
+	juce::AudioBuffer<float> kernel(1, kernelSize);
+	auto* samples = kernel.getWritePointer(0);
+
+	for (int i = 0; i < kernelSize; ++i)
+		samples[i] = fftData[static_cast<size_t>((i + kernelSize / 2) % kernelSize)] * window[static_cast<size_t>(i)];
+
+	for (auto& convolution : convolutions) //each engine takes ownership, so every one gets its own copy
+	{
+		juce::AudioBuffer<float> copy(kernel);
+		convolution->loadImpulseResponse(std::move(copy), sampleRate,
+			juce::dsp::Convolution::Stereo::no,
+			juce::dsp::Convolution::Trim::no,
+			juce::dsp::Convolution::Normalise::no);
+	}
+}
+
+void LinearPhaseEqualizer::reset() noexcept
+{
+	for (auto& convolution : convolutions)
+		convolution->reset();
+}
+
+void LinearPhaseEqualizer::restart() noexcept
+{
+	reset();
+	samplesHeard = 0;
+	ready.store(false, std::memory_order_release);
+}
+
+void LinearPhaseEqualizer::process(const juce::dsp::AudioBlock<float>& block)
+{
+	const auto numChannels = static_cast<int>(block.getNumChannels());
+
+	for (int first = 0, i = 0; first < numChannels && i < static_cast<int>(convolutions.size()); first += 2, ++i)
+	{
+		auto pair = block.getSubsetChannelBlock(static_cast<size_t>(first), static_cast<size_t>(juce::jmin(2, numChannels - first)));
+		juce::dsp::ProcessContextReplacing<float> context(pair);
+		convolutions[static_cast<size_t>(i)]->process(context);
+	}
+
+	//the engines start out on a one sample impulse and swap the kernel in while processing
+	auto loaded = !convolutions.empty();
+
+	for (auto& convolution : convolutions)
+		loaded = loaded && convolution->getCurrentIRSize() == kernelSize;
+
+	samplesHeard = loaded ? juce::jmin(samplesHeard + static_cast<int>(block.getNumSamples()), kernelSize) : 0;
+	ready.store(samplesHeard >= kernelSize, std::memory_order_release);
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    Linear phase alternative to the IIR chain. The magnitude response of the
+    current coefficient set is turned into a symmetric FIR kernel on the
+    designer thread and run through partitioned FFT convolution.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "CoefficientDesigner.h"
+
+class LinearPhaseEqualizer : private juce::TimeSliceClient
+{
+public:
+	LinearPhaseEqualizer() = default;
+	~LinearPhaseEqualizer() override;
+
+	void prepare(double sampleRate, int maximumBlockSize, int numChannels);
+	void release();
+
+	//the kernel is symmetric around its centre, so this is half of its length
+	int getLatencySamples() const noexcept { return kernelSize / 2; }
+
+	//any thread but the audio thread: the next kernel is built from this set
+	void setTarget(const ChainCoefficients& chainCoefficients);
+
+	//offline, after prepare() and the first setTarget(): builds that kernel on the calling thread
+	//instead of the shared designer thread, and runs silence through the convolutions until they
+	//have swapped it in and faded it up. Returns isReady(), false if that took longer than loadTimeoutMs
+	bool loadNow();
+
+	//true once the convolutions run a kernel and have heard a whole kernel's length of input through
+	//it, so what comes out is complete. Loading happens on a background thread and only takes effect
+	//inside process(), so this is what actually tells the kernel is in
+	bool isReady() const noexcept { return ready.load(std::memory_order_acquire); }
+
+	//audio thread: clears what the convolutions still hold of past input, the kernel stays loaded.
+	//Only for silent input, silence is what they would have heard
+	void reset() noexcept;
+
+	//audio thread: for when process() starts being called again after a break in the input. Clears
+	//the convolutions, and isReady() waits for a kernel's length of input again
+	void restart() noexcept;
+
+	void process(const juce::dsp::AudioBlock<float>& block);
+
+private:
+	int useTimeSlice() override;
+	void buildAndLoadKernel(const ChainCoefficients& chainCoefficients);
+
+	static constexpr int rebuildIntervalMs = 40; //kernels are crossfaded in, no point in building more often
+	static constexpr int loadTimeoutMs = 10000;
+
+	juce::CriticalSection targetLock; //between setTarget() and the designer thread only
+	ChainCoefficients target;
+	bool targetChanged{ false };
+
+	double sampleRate{ 0.0 };
+	int blockSize{ 0 }, channels{ 0 };
+	int kernelSize{ 0 };
+	std::unique_ptr<juce::dsp::FFT> fft;
+	std::vector<float> fftData, window;
+
+	//juce::dsp::Convolution handles at most two channels, so there is one engine per pair,
+	//all sharing one background loading thread
+	juce::dsp::ConvolutionMessageQueue loadingQueue;
+	std::vector<std::unique_ptr<juce::dsp::Convolution>> convolutions;
+
+	int samplesHeard{ 0 };					//since the kernel went in, or since restart()
+	std::atomic<bool> ready{ false };
+
+	juce::SharedResourcePointer<CoefficientDesignerThread> designerThread;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(LinearPhaseEqualizer)
+};
@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    Timing of processBlock, split into control and DSP work.
+
+  ==============================================================================
+*/
+
+#include "PerformanceMonitor.h"
+
+namespace
+{
+	std::atomic<int> nextInstanceId{ 1 };
+
+	double ticksToMs(juce::int64 ticks) noexcept
+	{
+		return juce::Time::highResolutionTicksToSeconds(ticks) * 1000.0;
+	}
+}
+
+PerformanceMonitor::PerformanceMonitor()
+	: instanceId(nextInstanceId++) //numbered in creation order, so a log line can be matched to a track
+{
+   #if EQ_PERFORMANCE_LOG
+	startTimer(1000);
+   #endif
+}
+
+PerformanceMonitor::~PerformanceMonitor()
+{
+   #if EQ_PERFORMANCE_LOG
+	stopTimer();
+   #endif
+}
+
+void PerformanceMonitor::prepare(double newSampleRate, int maximumBlockSize)
+{
+	sampleRate = newSampleRate;
+	loadMeasurer.reset(newSampleRate, maximumBlockSize);
+
+	worstBlockMs = worstControlMs = worstDspMs = 0.f;
+	numBlocks = numOverruns = controlOverruns = dspOverruns = 0;
+
+	for (auto& bucket : histogram)
+		bucket = 0;
+
+   #if EQ_PERFORMANCE_LOG
+	lastLoggedOverruns = 0;
+   #endif
+}
+
+void PerformanceMonitor::beginBlock() noexcept
+{
+	blockStartTicks = juce::Time::getHighResolutionTicks();
+}
+
+void PerformanceMonitor::endControl() noexcept
+{
+	controlEndTicks = juce::Time::getHighResolutionTicks();
+}
+
+void PerformanceMonitor::endBlock(int numSamples) noexcept
+{
+	const auto endTicks = juce::Time::getHighResolutionTicks();
+
+	const auto controlMs = ticksToMs(controlEndTicks - blockStartTicks);
+	const auto dspMs = ticksToMs(endTicks - controlEndTicks);
+	const auto blockMs = controlMs + dspMs;
+
+	loadMeasurer.registerRenderTime(blockMs, numSamples);
+
+	storeMax(worstBlockMs, static_cast<float>(blockMs));
+	storeMax(worstControlMs, static_cast<float>(controlMs));
+	storeMax(worstDspMs, static_cast<float>(dspMs));
+
+	const auto microseconds = static_cast<juce::uint32>(blockMs * 1000.0);
+	const auto bucket = microseconds == 0 ? 0 : juce::jmin(numHistogramBuckets - 1, 1 + juce::findHighestSetBit(microseconds));
+	histogram[static_cast<size_t>(bucket)].store(histogram[static_cast<size_t>(bucket)].load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	numBlocks.store(numBlocks.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+	const auto deadlineMs = numSamples * 1000.0 / sampleRate;
+
+	if (blockMs > deadlineMs)
+	{
+		auto& cause = controlMs > dspMs ? controlOverruns : dspOverruns;
+		cause.store(cause.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+
+		//counted last, so a reader that sees the overrun also sees what caused it
+		numOverruns.store(numOverruns.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+	}
+}
+
+void PerformanceMonitor::storeMax(std::atomic<float>& target, float value) noexcept
+{
+	if (value > target.load(std::memory_order_relaxed))
+		target.store(value, std::memory_order_relaxed);
+}
+
+PerformanceMonitor::Snapshot PerformanceMonitor::getSnapshot() const noexcept
+{
+	Snapshot snapshot;
+
+	snapshot.instanceId = instanceId;
+	snapshot.numOverruns = numOverruns.load(std::memory_order_acquire);
+	snapshot.controlOverruns = controlOverruns.load(std::memory_order_relaxed);
+	snapshot.dspOverruns = dspOverruns.load(std::memory_order_relaxed);
+	snapshot.load = loadMeasurer.getLoadAsProportion();
+	snapshot.worstBlockMs = worstBlockMs.load(std::memory_order_relaxed);
+	snapshot.worstControlMs = worstControlMs.load(std::memory_order_relaxed);
+	snapshot.worstDspMs = worstDspMs.load(std::memory_order_relaxed);
+	snapshot.numBlocks = numBlocks.load(std::memory_order_relaxed);
+
+	for (size_t i = 0; i < histogram.size(); ++i)
+		snapshot.histogram[i] = histogram[i].load(std::memory_order_relaxed);
+
+	return snapshot;
+}
+
+#if EQ_PERFORMANCE_LOG
+void PerformanceMonitor::timerCallback()
+{
+	const auto snapshot = getSnapshot();
+
+	if (snapshot.numOverruns == lastLoggedOverruns)
+		return;
+
+	juce::Logger::writeToLog("EQ instance " + juce::String(snapshot.instanceId)
+		+ ": " + juce::String(snapshot.numOverruns - lastLoggedOverruns) + " missed deadlines"
+		+ " (control " + juce::String(snapshot.controlOverruns) + ", dsp " + juce::String(snapshot.dspOverruns) + " in total)"
+		+ ", worst block " + juce::String(snapshot.worstBlockMs, 3) + " ms"
+		+ " (control " + juce::String(snapshot.worstControlMs, 3) + " ms, dsp " + juce::String(snapshot.worstDspMs, 3) + " ms)"
+		+ ", load " + juce::String(snapshot.load * 100.0, 1) + " %");
+
+	lastLoggedOverruns = snapshot.numOverruns;
+}
+#endif
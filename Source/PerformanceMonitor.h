@@ -0,0 +1,81 @@
+/*
+  ==============================================================================
+
+    Timing of processBlock, split into the control work at the start of the
+    block (taking over new designs and program changes) and the DSP work
+    (the filters, oversampling or convolution, including the per sub-block
+    coefficient glides). The audio thread only writes atomics it alone owns,
+    readers take a Snapshot from any thread whenever they like.
+
+    Define EQ_PERFORMANCE_LOG=1 to also get a line in the JUCE log, once a
+    second at most, whenever an instance misses its deadline.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef EQ_PERFORMANCE_LOG
+ #define EQ_PERFORMANCE_LOG 0
+#endif
+
+class PerformanceMonitor
+   #if EQ_PERFORMANCE_LOG
+	: private juce::Timer
+   #endif
+{
+public:
+	//block durations are counted in buckets that double in width: below 1 us, 1 - 2 us, 2 - 4 us and so on
+	static constexpr int numHistogramBuckets = 16;
+
+	struct Snapshot
+	{
+		int instanceId{ 0 };
+		double load{ 0.0 };					//AudioProcessLoadMeasurer's smoothed proportion of the deadline
+		double worstBlockMs{ 0.0 }, worstControlMs{ 0.0 }, worstDspMs{ 0.0 };
+		juce::uint32 numBlocks{ 0 };
+		juce::uint32 numOverruns{ 0 };			//blocks that took longer than their own duration
+		juce::uint32 controlOverruns{ 0 };		//of those, the ones where the control work took longer than the DSP
+		juce::uint32 dspOverruns{ 0 };
+		std::array<juce::uint32, numHistogramBuckets> histogram{};
+	};
+
+	PerformanceMonitor();
+	~PerformanceMonitor();
+
+	//message thread, while the audio thread is stopped. Clears all the numbers
+	void prepare(double sampleRate, int maximumBlockSize);
+
+	//audio thread, wait free. Call in this order once per block
+	void beginBlock() noexcept;
+	void endControl() noexcept;
+	void endBlock(int numSamples) noexcept;
+
+	//any thread
+	Snapshot getSnapshot() const noexcept;
+	int getInstanceId() const noexcept { return instanceId; }
+
+private:
+   #if EQ_PERFORMANCE_LOG
+	void timerCallback() override;
+	juce::uint32 lastLoggedOverruns{ 0 };
+   #endif
+
+	//single writer, so a plain load and store is enough to keep the maximum
+	static void storeMax(std::atomic<float>& target, float value) noexcept;
+
+	const int instanceId;
+
+	juce::AudioProcessLoadMeasurer loadMeasurer;
+	double sampleRate{ 44100.0 };
+
+	juce::int64 blockStartTicks{ 0 }, controlEndTicks{ 0 };
+
+	std::atomic<float> worstBlockMs{ 0.f }, worstControlMs{ 0.f }, worstDspMs{ 0.f };
+	std::atomic<juce::uint32> numBlocks{ 0 }, numOverruns{ 0 }, controlOverruns{ 0 }, dspOverruns{ 0 };
+	std::array<std::atomic<juce::uint32>, numHistogramBuckets> histogram{};
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceMonitor)
+};
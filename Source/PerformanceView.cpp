@@ -0,0 +1,58 @@
+/*
+  ==============================================================================
+
+    A one line readout of the processor's PerformanceMonitor.
+
+  ==============================================================================
+*/
+
+#include "PerformanceView.h"
+
+PerformanceView::PerformanceView(const PerformanceMonitor& monitor) : performanceMonitor(monitor)
+{
+	setInterceptsMouseClicks(false, false);
+	startTimerHz(refreshRate);
+}
+
+void PerformanceView::timerCallback()
+{
+	const auto latest = performanceMonitor.getSnapshot();
+
+	if (latest.numBlocks == snapshot.numBlocks && latest.numOverruns == snapshot.numOverruns)
+		return; //transport stopped, nothing to redraw
+
+	snapshot = latest;
+	repaint();
+}
+
+void PerformanceView::paint(juce::Graphics& g)
+{
+	using namespace juce;
+
+	auto bounds = getLocalBounds().toFloat();
+
+	//histogram on the right, each bar scaled against the fullest bucket
+	auto histogramArea = bounds.removeFromRight(bounds.getHeight() * 4.f).reduced(1.f);
+	const auto barWidth = histogramArea.getWidth() / PerformanceMonitor::numHistogramBuckets;
+	const auto fullest = static_cast<float>(jmax(1u, *std::max_element(snapshot.histogram.begin(), snapshot.histogram.end())));
+
+	g.setColour(Colour(255u, 154u, 1u).withAlpha(0.7f));
+
+	for (int i = 0; i < PerformanceMonitor::numHistogramBuckets; ++i)
+	{
+		const auto height = histogramArea.getHeight() * static_cast<float>(snapshot.histogram[static_cast<size_t>(i)]) / fullest;
+		g.fillRect(histogramArea.getX() + i * barWidth, histogramArea.getBottom() - height, jmax(1.f, barWidth - 1.f), height);
+	}
+
+	String text;
+	text << "#" << snapshot.instanceId
+		<< "  load " << String(snapshot.load * 100.0, 1) << "%"
+		<< "  worst " << String(snapshot.worstBlockMs, 2) << " ms"
+		<< " (ctl " << String(snapshot.worstControlMs, 2) << " / dsp " << String(snapshot.worstDspMs, 2) << ")"
+		<< "  overruns " << static_cast<int>(snapshot.numOverruns)
+		<< " (ctl " << static_cast<int>(snapshot.controlOverruns) << " / dsp " << static_cast<int>(snapshot.dspOverruns) << ")";
+
+	g.setColour(snapshot.numOverruns > 0 ? Colours::red : Colours::grey);
+	g.setFont(bounds.getHeight() - 2.f);
+	g.drawFittedText(text, bounds.reduced(2.f, 0.f).toNearestInt(), Justification::centredRight, 1);
+}
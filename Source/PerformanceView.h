@@ -0,0 +1,32 @@
+/*
+  ==============================================================================
+
+    A one line readout of the processor's PerformanceMonitor in the corner
+    of the editor: instance number, load, worst block split into control and
+    DSP time, missed deadlines and a small histogram of block durations.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "PerformanceMonitor.h"
+
+class PerformanceView : public juce::Component, private juce::Timer
+{
+public:
+	explicit PerformanceView(const PerformanceMonitor& monitor);
+
+	void paint(juce::Graphics& g) override;
+
+private:
+	void timerCallback() override;
+
+	static constexpr int refreshRate = 4;
+
+	const PerformanceMonitor& performanceMonitor;
+	PerformanceMonitor::Snapshot snapshot;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PerformanceView)
+};
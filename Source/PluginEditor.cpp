@@ -24,66 +24,128 @@ void LookAndFeel::drawRotarySlider(juce::Graphics& g,
 	using namespace juce;
 	auto bounds = Rectangle<float>(x, y, width, height);
 
+	drawRotaryBody(g, bounds);
+
+	if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider))
+	{
+		jassert(rotaryStartAngle < rotaryEndAngle);
+
+		auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
+
+		drawRotaryPointer(g, createRotaryPointer(bounds), bounds.getCentre(), sliderAngRad);
+
+		g.setFont(rswl->getTextHeight());
+		auto text = rswl->getDisplayString();
+
+		drawValueText(g, bounds, text, g.getCurrentFont().getStringWidth(text), rswl->getTextHeight());
+	}
+}
+
+void LookAndFeel::drawRotaryBody(juce::Graphics& g, juce::Rectangle<float> bounds)
+{
+	using namespace juce;
+
 	g.setColour(Colour(64u, 59u, 62u));
 	g.fillEllipse(bounds);
 
 	g.setColour(Colour(255u, 154, 1u));
 	g.drawEllipse(bounds, 1.f);
+}
 
+juce::Path LookAndFeel::createRotaryPointer(juce::Rectangle<float> bounds) const
+{
+	auto center = bounds.getCentre();
 
-	if (auto* rswl = dynamic_cast<RotarySliderWithLabels*>(&slider))
-	{
-		auto center = bounds.getCentre();
+	juce::Rectangle<float> r;
+	r.setLeft(center.getX() - 2);
+	r.setRight(center.getX() + 2);
+	r.setTop(bounds.getY());
+	r.setBottom(center.getY());
 
-		Path p;
+	juce::Path p;
+	p.addRoundedRectangle(r, 2.f);
 
-		Rectangle<float> r;
-		r.setLeft(center.getX() - 2);
-		r.setRight(center.getX() + 2);
-		r.setTop(bounds.getY());
-		r.setBottom(center.getY());
+	return p;
+}
 
-		p.addRoundedRectangle(r, 2.f);
+void LookAndFeel::drawRotaryPointer(juce::Graphics& g, const juce::Path& pointer, juce::Point<float> centre, float angle)
+{
+	g.setColour(juce::Colour(255u, 154, 1u));
+	g.fillPath(pointer, juce::AffineTransform::rotation(angle, centre.getX(), centre.getY()));
+}
 
-		jassert(rotaryStartAngle < rotaryEndAngle);
+void LookAndFeel::drawValueText(juce::Graphics& g, juce::Rectangle<float> bounds, const juce::String& text, int textWidth, int textHeight)
+{
+	using namespace juce;
 
-		auto sliderAngRad = jmap(sliderPosProportional, 0.f, 1.f, rotaryStartAngle, rotaryEndAngle);
+	Rectangle<float> r;
+	r.setSize(textWidth + 4, textHeight + 2);
+	r.setCentre(bounds.getCentre());
 
-		p.applyTransform(AffineTransform().rotated(sliderAngRad, center.getX(), center.getY()));
+	g.setColour(Colour(63u, 60u,84u));
+	g.fillRect(r);
 
-		g.fillPath(p);
+	g.setColour(Colours::green);
+	g.setFont(textHeight);
+	g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
+}
 
-		g.setFont(rswl->getTextHeight());
-		auto text = rswl->getDisplayString();
-		auto strWidth = g.getCurrentFont().getStringWidth(text);
+//==============================================================================
+namespace
+{
+	const auto startAng = juce::degreesToRadians(180.f + 45.f);
+	const auto endAng = juce::degreesToRadians(180.f - 45.f) + juce::MathConstants<float>::twoPi;
+}
 
-		r.setSize(strWidth + 4, rswl->getTextHeight() + 2);
-		r.setCentre(bounds.getCentre());
+void RotarySliderWithLabels::paint(juce::Graphics &g)
+{
+	using namespace juce;
 
-		g.setColour(Colour(63u, 60u,84u));
-		g.fillRect(r);
+	//with 30+ editors open every paint counts, so only the pointer and the value text are drawn live
+	const auto scale = g.getInternalContext().getPhysicalPixelScaleFactor();
 
-		g.setColour(Colours::green);
-		g.drawFittedText(text, r.toNearestInt(), juce::Justification::centred, 1);
+	if (background.isNull() || scale != backgroundScale)
+		renderBackground(scale);
 
+	g.drawImage(background, getLocalBounds().toFloat());
 
-	}
+	auto range = getRange();
+	auto sliderBounds = getSliderBounds().toFloat();
 
+	auto ang = jmap(static_cast<float>(jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0)), 0.f, 1.f, startAng, endAng);
+	lnf->drawRotaryPointer(g, pointer, sliderBounds.getCentre(), ang);
 
+	if (getValue() != displayedValue)
+	{
+		displayedValue = getValue();
+		displayString = getDisplayString();
+		displayStringWidth = Font(getTextHeight()).getStringWidth(displayString);
+	}
 
-	
+	lnf->drawValueText(g, sliderBounds, displayString, displayStringWidth, getTextHeight());
 }
 
-//==============================================================================
+void RotarySliderWithLabels::resized()
+{
+	juce::Slider::resized();
 
-void RotarySliderWithLabels::paint(juce::Graphics &g)
+	background = {}; //re-rendered by the next paint, at whatever scale that paint runs at
+	pointer = lnf->createRotaryPointer(getSliderBounds().toFloat());
+}
+
+void RotarySliderWithLabels::renderBackground(float scale)
 {
 	using namespace juce;
 
-	auto startAng = degreesToRadians(180.f + 45.f);
-	auto endAng = degreesToRadians(180.f - 45.f) + MathConstants<float>::twoPi;
+	backgroundScale = scale;
 
-	auto range = getRange();
+	background = Image(Image::ARGB,
+		jmax(1, roundToInt(getWidth() * scale)),
+		jmax(1, roundToInt(getHeight() * scale)),
+		true);
+
+	Graphics g(background);
+	g.addTransform(AffineTransform::scale(scale));
 
 	auto sliderBounds = getSliderBounds();
 
@@ -92,15 +154,7 @@ void RotarySliderWithLabels::paint(juce::Graphics &g)
 	g.setColour(Colours::yellow);
 	g.drawRect(sliderBounds);*/
 
-	getLookAndFeel().drawRotarySlider(	g,
-										sliderBounds.getX(),
-										sliderBounds.getY(),
-										sliderBounds.getWidth(),
-										sliderBounds.getHeight(),
-										jmap(getValue(), range.getStart(), range.getEnd(), 0.0, 1.0),
-										startAng,
-										endAng,
-										*this); //this represents the slider that has been created this function doesnt make a new slider it just reforms the old one
+	lnf->drawRotaryBody(g, sliderBounds.toFloat());
 
 	auto center = sliderBounds.toFloat().getCentre();
 	auto radius = sliderBounds.getWidth() * 0.5f;
@@ -118,16 +172,13 @@ void RotarySliderWithLabels::paint(juce::Graphics &g)
 
 		auto c = center.getPointOnCircumference(radius + getTextHeight() * 0.5f + 1, ang); // a little bit past the Circle
 
-			Rectangle<float> r;
+		Rectangle<float> r;
 		auto str = labels[i].label;
 		r.setSize(g.getCurrentFont().getStringWidth(str), getTextHeight());
 		r.setCentre(c);
 		r.setY(r.getY() + getTextHeight()); // shifting labels down 
 		g.drawFittedText(str, r.toNearestInt(), juce::Justification::centred, 1);
 	}
-
-
-
 }
 
 juce::Rectangle<int> RotarySliderWithLabels::getSliderBounds() const
@@ -150,13 +201,14 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 {
 	//return juce::String(getValue());
 
-	if (auto* choiceParam = dynamic_cast<juce::AudioParameterChoice*>(param))
-		return choiceParam->getCurrentChoiceName();
+	//the slider value is the choice index, so this stays in step with what is drawn
+	if (choiceParam != nullptr)
+		return choiceParam->choices[juce::roundToInt(getValue())];
 
 	juce::String str;
 	bool addK = false;
 
-	if (auto* floatParam = dynamic_cast<juce::AudioParameterFloat*>(param))
+	if (auto* floatParam = dynamic_cast<juce::AudioParameterFloat*>(param)) //only runs when the value moves
 	{
 		float val = getValue();
 
@@ -187,13 +239,16 @@ juce::String RotarySliderWithLabels::getDisplayString() const
 //==============================================================================
 AudioPluginAudioProcessorEditor::AudioPluginAudioProcessorEditor(AudioPluginAudioProcessor& p)
 	: AudioProcessorEditor(&p), audioProcessor(p),
+	analyzer(p),
+	responseCurve(p),
+	performanceView(p.performance),
 	peakFreqSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "Hz"),
-	peakGainSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "dB"),
-	peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Freq"), ""),
-	lowCutSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "Hz"),
-	highCutSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "Hz"),
-	lowCutSlopeSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "dB/Oct"),
-	highCutSlopeSlider(*audioProcessor.apvts.getParameter("Peak Freq"), "dB/Oct"),
+	peakGainSlider(*audioProcessor.apvts.getParameter("Peak Gain"), "dB"),
+	peakQualitySlider(*audioProcessor.apvts.getParameter("Peak Quality"), ""),
+	lowCutSlider(*audioProcessor.apvts.getParameter("LowCut Freq"), "Hz"),
+	highCutSlider(*audioProcessor.apvts.getParameter("HighCut Freq"), "Hz"),
+	lowCutSlopeSlider(*audioProcessor.apvts.getParameter("LowCut Slope"), "dB/Oct"),
+	highCutSlopeSlider(*audioProcessor.apvts.getParameter("HighCut Slope"), "dB/Oct"),
 
 	peakFreqSliderAttachment(audioProcessor.apvts, "Peak Freq", peakFreqSlider),
 	highCutSliderAttachment(audioProcessor.apvts, "HighCut Freq", highCutSlider),
@@ -251,9 +306,8 @@ void AudioPluginAudioProcessorEditor::paint (juce::Graphics& g)
     // (Our component is opaque, so we must completely fill the background with a solid colour)
     g.fillAll (getLookAndFeel().findColour (juce::ResizableWindow::backgroundColourId));
 
-    g.setColour (juce::Colours::white);
-    g.setFont (15.0f);
-    g.drawFittedText ("Hello World!", getLocalBounds(), juce::Justification::centred, 1);
+	g.setColour(juce::Colours::black);
+	g.fillRect(analyzer.getBounds());
 }
 
 void AudioPluginAudioProcessorEditor::resized()
@@ -261,7 +315,11 @@ void AudioPluginAudioProcessorEditor::resized()
     // This is generally where you'll want to lay out the positions of any
     // subcomponents in your editor..
 	auto bounds = getLocalBounds();
-	//auto responseArea = bounds.removeFromTop(bounds.getHeight() * 0.33);
+	auto responseArea = bounds.removeFromTop(bounds.getHeight() * 0.33);
+
+	analyzer.setBounds(responseArea);
+	responseCurve.setBounds(responseArea);
+	performanceView.setBounds(responseArea.withHeight(14));
 
 	auto lowCutArea = bounds.removeFromLeft(bounds.getWidth() * 0.33);
 	auto highCutArea = bounds.removeFromRight(bounds.getWidth() * 0.5);
@@ -282,6 +340,9 @@ std::vector<juce::Component*> AudioPluginAudioProcessorEditor:: getComps()
 {
 	return
 	{
+		&analyzer,
+		&responseCurve,
+		&performanceView,
 		&peakFreqSlider,
 		&peakGainSlider,
 		&peakQualitySlider,
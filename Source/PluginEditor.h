@@ -10,6 +10,9 @@
 
 #include <JuceHeader.h>
 #include "PluginProcessor.h"
+#include "SpectrumAnalyzer.h"
+#include "ResponseCurve.h"
+#include "PerformanceView.h"
 
 struct LookAndFeel : juce::LookAndFeel_V4
 {
@@ -19,6 +22,12 @@ struct LookAndFeel : juce::LookAndFeel_V4
 		float rotaryStartAngle,
 		float rotaryEndAngle,
 		juce::Slider&) override;
+
+	//the pieces drawRotarySlider is made of, so RotarySliderWithLabels can cache the parts that don't move
+	void drawRotaryBody(juce::Graphics&, juce::Rectangle<float> bounds);
+	juce::Path createRotaryPointer(juce::Rectangle<float> bounds) const;
+	void drawRotaryPointer(juce::Graphics&, const juce::Path& pointer, juce::Point<float> centre, float angle);
+	void drawValueText(juce::Graphics&, juce::Rectangle<float> bounds, const juce::String& text, int textWidth, int textHeight);
 };
 
 
@@ -28,9 +37,10 @@ struct RotarySliderWithLabels : juce::Slider
 		juce::Slider(juce::Slider::SliderStyle::RotaryHorizontalVerticalDrag,
 			juce::Slider::TextEntryBoxPosition::NoTextBox),
 		param(&rap),
+		choiceParam(dynamic_cast<juce::AudioParameterChoice*>(&rap)),
 		suffix(unitSuffix)
 	{
-		setLookAndFeel(&lnf);
+		setLookAndFeel(lnf);
 	}
 
 	~RotarySliderWithLabels()
@@ -50,6 +60,7 @@ struct RotarySliderWithLabels : juce::Slider
 
 
 	void paint(juce::Graphics& g) override;
+	void resized() override;
 	juce::Rectangle<int> getSliderBounds() const;
 	int getTextHeight() const { return 14; }
 	juce::String getDisplayString() const;
@@ -58,10 +69,23 @@ struct RotarySliderWithLabels : juce::Slider
 
 	private: 
 
-		LookAndFeel lnf;
+		//knob body and labels, redrawn only when the size or the display scale changes
+		void renderBackground(float scale);
+
+		juce::SharedResourcePointer<LookAndFeel> lnf; //one for every slider in every open editor
 		juce::RangedAudioParameter* param;
+		juce::AudioParameterChoice* choiceParam;
 		juce::String suffix;
 
+		juce::Image background;
+		float backgroundScale{ 0.f };
+		juce::Path pointer; //pointing straight up, rotated at draw time
+
+		//formatting and measuring the value text only happens when the value moves
+		double displayedValue{ std::numeric_limits<double>::quiet_NaN() };
+		juce::String displayString;
+		int displayStringWidth{ 0 };
+
 };
 
 
@@ -84,6 +108,10 @@ private:
     AudioPluginAudioProcessor& audioProcessor;
 
 
+	SpectrumAnalyzer analyzer;
+	ResponseCurve responseCurve;
+	PerformanceView performanceView;
+
 	RotarySliderWithLabels	peakFreqSlider,
 						peakGainSlider,
 						peakQualitySlider,
@@ -8,6 +8,7 @@
 
 #include "PluginProcessor.h"
 #include "PluginEditor.h"
+#include "PluginState.h"
 
 
 
@@ -24,6 +25,48 @@ AudioPluginAudioProcessor::AudioPluginAudioProcessor()
                        )
 #endif
 {
+	lowCutFreqParam = apvts.getRawParameterValue("LowCut Freq");
+	highCutFreqParam = apvts.getRawParameterValue("HighCut Freq");
+	lowCutSlopeParam = apvts.getRawParameterValue("LowCut Slope");
+	highCutSlopeParam = apvts.getRawParameterValue("HighCut Slope");
+	oversamplingParam = apvts.getRawParameterValue("Oversampling");
+	linearPhaseParam = apvts.getRawParameterValue("Linear Phase");
+	peakDynamicParam = apvts.getRawParameterValue("Peak Dynamic");
+	peakThresholdParam = apvts.getRawParameterValue("Peak Threshold");
+	peakRatioParam = apvts.getRawParameterValue("Peak Ratio");
+	peakAttackParam = apvts.getRawParameterValue("Peak Attack");
+	peakReleaseParam = apvts.getRawParameterValue("Peak Release");
+	stereoModeParam = apvts.getRawParameterValue("Stereo Mode");
+	lowCutChannelParam = apvts.getRawParameterValue("LowCut Channel");
+	highCutChannelParam = apvts.getRawParameterValue("HighCut Channel");
+
+	for (int band = 0; band < maxBands; ++band)
+	{
+		auto& params = bandParams[static_cast<size_t>(band)];
+		params.enabled = apvts.getRawParameterValue(getBandParameterID(band, "Enabled"));
+		params.type = apvts.getRawParameterValue(getBandParameterID(band, "Type"));
+		params.frequency = apvts.getRawParameterValue(getBandParameterID(band, "Freq"));
+		params.gain = apvts.getRawParameterValue(getBandParameterID(band, "Gain"));
+		params.quality = apvts.getRawParameterValue(getBandParameterID(band, "Quality"));
+		params.channel = apvts.getRawParameterValue(getBandParameterID(band, "Channel"));
+
+		jassert(params.enabled != nullptr && params.type != nullptr && params.frequency != nullptr
+			&& params.gain != nullptr && params.quality != nullptr && params.channel != nullptr);
+	}
+
+	jassert(lowCutFreqParam != nullptr && highCutFreqParam != nullptr
+		&& lowCutSlopeParam != nullptr && highCutSlopeParam != nullptr
+		&& oversamplingParam != nullptr && linearPhaseParam != nullptr
+		&& peakDynamicParam != nullptr && peakThresholdParam != nullptr && peakRatioParam != nullptr
+		&& peakAttackParam != nullptr && peakReleaseParam != nullptr
+		&& stereoModeParam != nullptr && lowCutChannelParam != nullptr && highCutChannelParam != nullptr);
+
+	PluginState::checkParameterIDs(*this);
+
+	designer.onPublished = [this](const ChainSettings& chainSettings, const ChainCoefficients& chainCoefficients)
+	{
+		handleNewDesign(chainSettings, chainCoefficients);
+	};
 }
 
 AudioPluginAudioProcessor::~AudioPluginAudioProcessor()
@@ -65,27 +108,40 @@ bool AudioPluginAudioProcessor::isMidiEffect() const
 
 double AudioPluginAudioProcessor::getTailLengthSeconds() const
 {
-    return 0.0;
+    return tailSeconds.load();
 }
 
 int AudioPluginAudioProcessor::getNumPrograms()
 {
-    return 1;   // NB: some hosts don't cope very well if you tell them there are 0 programs,
+    return presets.getNumPresets();   // NB: some hosts don't cope very well if you tell them there are 0 programs,
                 // so this should be at least 1, even if you're not really implementing programs.
 }
 
 int AudioPluginAudioProcessor::getCurrentProgram()
 {
-    return 0;
+    return presets.getCurrentPreset();
 }
 
 void AudioPluginAudioProcessor::setCurrentProgram (int index)
 {
+	if (!juce::isPositiveAndBelow(index, presets.getNumPresets()))
+		return;
+
+	presets.select(index); //the audio thread crossfades to the precomputed set on its next block
+
+	//and the parameters follow right away, hosts tend to read the state straight after switching
+	applyPresetSettings(presets.getPresetSettings(index));
+}
+
+void AudioPluginAudioProcessor::loadPresetParameters(int index)
+{
+	if (juce::isPositiveAndBelow(index, presets.getNumPresets()))
+		applyPresetSettings(presets.getPresetSettings(index));
 }
 
 const juce::String AudioPluginAudioProcessor::getProgramName (int index)
 {
-    return {};
+    return presets.getPresetName(index);
 }
 
 void AudioPluginAudioProcessor::changeProgramName (int index, const juce::String& newName)
@@ -97,24 +153,71 @@ void AudioPluginAudioProcessor::prepareToPlay (double sampleRate, int samplesPer
 {
     // Use this method as the place to do any pre-playback
     // initialisation that you need..
-	juce::dsp::ProcessSpec spec;
+	designer.release(); //the designer thread reads the latencies below
+
+	const auto numChannels = getTotalNumOutputChannels();
+	baseSampleRate = sampleRate;
+
+	//polyphase IIR half band stages, with the latency rounded to whole samples so it can be reported exactly
+	for (int i = Oversampling_2x; i <= Oversampling_4x; ++i)
+	{
+		oversamplers[i] = std::make_unique<juce::dsp::Oversampling<float>>(static_cast<size_t>(numChannels),
+			static_cast<size_t>(i),
+			juce::dsp::Oversampling<float>::filterHalfBandPolyphaseIIR,
+			true,
+			true);
+
+		oversamplers[i]->initProcessing(static_cast<size_t>(samplesPerBlock));
+		oversamplingLatencies[i] = juce::roundToInt(oversamplers[i]->getLatencyInSamples());
+	}
+
+	chain.prepare(numChannels, samplesPerBlock << Oversampling_4x); //sized for the negotiated layout, no allocation after this
+	fadingChain.prepare(numChannels, samplesPerBlock << Oversampling_4x);
+	fadeBuffer.setSize(numChannels, samplesPerBlock << Oversampling_4x);
+	fadeGains.resize(static_cast<size_t>(samplesPerBlock << Oversampling_4x));
+	dynamicPeak.prepare(numChannels, samplesPerBlock << Oversampling_4x);
+
+	performance.prepare(sampleRate, samplesPerBlock);
+	presets.prepare(sampleRate, !isNonRealtime()); //every preset at every rate, so program changes never design on the audio thread
+	linearPhase.prepare(sampleRate, samplesPerBlock, numChannels);
+	linearPhaseBuffer.setSize(numChannels, samplesPerBlock);
+	linearPhaseRunning = linearPhaseAudible = false;
+
+	iirDelay.prepare({ sampleRate, static_cast<juce::uint32>(samplesPerBlock), static_cast<juce::uint32>(numChannels) });
+	iirDelay.setMaximumDelayInSamples(linearPhase.getLatencySamples());
+	pathFade.reset(sampleRate, crossfadeSeconds);
 
-	spec.maximumBlockSize = samplesPerBlock;
+	//offline nothing polls the parameters, every block designs its own set so renders don't depend on timing
+	designPerBlock = isNonRealtime();
+	designer.prepare(sampleRate, !designPerBlock); //designs the first set synchronously, and hands it to linearPhase if it's on
 
-	spec.numChannels = 1;
+	//offline the kernel is built on this thread and swapped in before the first block, nothing has to wait for it
+	if (designPerBlock && linearPhaseParam->load() > 0.5f && linearPhase.loadNow())
+		linearPhaseRunning = linearPhaseAudible = true;
 
-	spec.sampleRate = sampleRate;
+	pathFade.setCurrentAndTargetValue(linearPhaseAudible ? 1.f : 0.f);
 
-	leftChain.prepare(spec); //Channel output not just Mono
-	rightChain.prepare(spec);
+	if (auto* chainCoefficients = designer.pullLatest())
+		switchOversampling(*chainCoefficients);
 
-	updateFilters();
+	//the host asks for the latency right after this, later changes are passed on by the timer
+	updateLatency();
+	reportLatency();
+
+	if (designPerBlock)
+		stopTimer();
+	else
+		startTimer(latencySyncIntervalMs);
 }
 
 void AudioPluginAudioProcessor::releaseResources()
 {
     // When playback stops, you can use this as an opportunity to free up any
     // spare memory, etc.
+	stopTimer();
+	designer.release();
+	linearPhase.release();
+	presets.release();
 }
 
 #ifndef JucePlugin_PreferredChannelConfigurations
@@ -124,12 +227,9 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
     juce::ignoreUnused (layouts);
     return true;
   #else
-    // This is the place where you check if the layout is supported.
-    // In this template code we only support mono or stereo.
-    // Some plugin hosts, such as certain GarageBand versions, will only
-    // load plugins that support stereo bus layouts.
-    if (layouts.getMainOutputChannelSet() != juce::AudioChannelSet::mono()
-     && layouts.getMainOutputChannelSet() != juce::AudioChannelSet::stereo())
+    // Any layout works, from mono up to surround and ambisonic beds:
+    // the chain pool gives every channel its own lane.
+    if (layouts.getMainOutputChannelSet().isDisabled())
         return false;
 
     // This checks if the input layout matches the output layout
@@ -146,6 +246,9 @@ bool AudioPluginAudioProcessor::isBusesLayoutSupported (const BusesLayout& layou
 void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer, juce::MidiBuffer& midiMessages)
 {
     juce::ScopedNoDenormals noDenormals;
+	const RealtimeGuard::ScopedRealtimeSection realtimeSection; //only does anything in EQ_REALTIME_GUARD builds
+	performance.beginBlock();
+
     auto totalNumInputChannels  = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
@@ -158,18 +261,411 @@ void AudioPluginAudioProcessor::processBlock (juce::AudioBuffer<float>& buffer,
     for (auto i = totalNumInputChannels; i < totalNumOutputChannels; ++i)
         buffer.clear (i, 0, buffer.getNumSamples());
 
-	updateFilters(); //Always update your parameters first
+	//Always update your parameters first. Live the designer thread did the heavy lifting, offline the
+	//set is designed here from this block's parameters
+	if (auto* chainCoefficients = designPerBlock ? designer.designForBlock() : designer.pullLatest())
+	{
+		if (chainCoefficients->sampleRate != chainSampleRate)
+			switchOversampling(*chainCoefficients);
+		else if (designPerBlock) //from the last block's values to this one's, reached at the end of the block
+			chain.rampTo(*chainCoefficients, buffer.getNumSamples() << activeOversampling);
+		else
+			chain.rampTo(*chainCoefficients, rampSamples);
+	}
+
+	for (const auto metadata : midiMessages)
+	{
+		const auto message = metadata.getMessage();
+
+		if (message.isProgramChange())
+			presets.select(message.getProgramChangeNumber());
+	}
+
+	if (auto* presetCoefficients = presets.pullSelected(activeOversampling))
+		switchProgram(*presetCoefficients);
+
+	updateDynamics();
+
+	performance.endControl();
+
+	const auto analyse = analyzerActive.load(std::memory_order_relaxed); //costs nothing while no editor is open
+
+	if (analyse)
+		preAnalyzerFifo.push(buffer);
+
+	if (updateIdleState(buffer))
+	{
+		buffer.clear(); //also marks the buffer as silent, so whatever comes after us can skip it too
+	}
+	else
+	{
+		juce::dsp::AudioBlock<float> block(buffer);
+		processEqualizer(block);
+	}
+
+	if (analyse)
+		postAnalyzerFifo.push(buffer);
+
+	performance.endBlock(buffer.getNumSamples());
+}
+
+bool AudioPluginAudioProcessor::updateIdleState(const juce::AudioBuffer<float>& buffer)
+{
+	const auto numSamples = buffer.getNumSamples();
+
+	//getMagnitude is findMinAndMax per channel, which is vectorised. A buffer the host
+	//already flagged as cleared doesn't even need that
+	const auto silent = buffer.hasBeenCleared() || buffer.getMagnitude(0, numSamples) < silenceThreshold;
+
+	if (!silent)
+	{
+		silentSamples = 0;
+		idle = false;
+		return false;
+	}
+
+	if (!idle)
+	{
+		silentSamples = juce::jmin(silentSamples + numSamples, std::numeric_limits<int>::max() / 2);
+
+		//a program fade still has the old chain to get rid of, that takes 30 ms at most
+		if (silentSamples < tailSamples.load(std::memory_order_relaxed) || crossfade.isSmoothing())
+			return false;
+
+		idle = true;
+		flushStates();
+	}
+
+	//nothing can click while nothing is processed, so glides and program fades end on the spot
+	if (chain.isRamping())
+		chain.finishRamp();
+
+	crossfade.setCurrentAndTargetValue(crossfade.getTargetValue());
+	pathFade.setCurrentAndTargetValue(pathFade.getTargetValue());
+	return true;
+}
+
+void AudioPluginAudioProcessor::flushStates() noexcept
+{
+	chain.reset();
+	fadingChain.reset();
+	linearPhase.reset();
+	iirDelay.reset();
+	dynamicPeak.reset();
+
+	if (activeOversampler != nullptr)
+		activeOversampler->reset();
+}
+
+void AudioPluginAudioProcessor::processEqualizer(juce::dsp::AudioBlock<float>& block)
+{
+	const auto wantsLinearPhase = linearPhaseParam->load() > 0.5f;
+
+	if (wantsLinearPhase && !linearPhaseRunning) //whatever the convolutions and the delay hold is from before the break
+	{
+		linearPhaseRunning = true;
+		linearPhase.restart();
+		iirDelay.reset();
+	}
+
+	if (!linearPhaseRunning)
+	{
+		processIIR(block);
+		updateLatency();
+		return;
+	}
+
+	//linear phase runs at the host rate on a copy, the kernel already carries the oversampled response
+	const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(linearPhaseBuffer.getNumChannels()));
+	const auto numSamples = block.getNumSamples();
+	juce::dsp::AudioBlock<float> linearBlock(linearPhaseBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+
+	linearBlock.copyFrom(block);
+	linearPhase.process(linearBlock);
+	processIIR(block);
+
+	//it is heard once its kernel is in, until then the IIR chain stands in at its own latency
+	const auto audible = wantsLinearPhase && linearPhase.isReady();
+
+	if (audible != linearPhaseAudible)
+	{
+		linearPhaseAudible = audible;
+		pathFade.setTargetValue(audible ? 1.f : 0.f);
+	}
+
+	const auto delayed = linearPhaseAudible || pathFade.getCurrentValue() > 0.f;
+	iirDelay.setDelay(static_cast<float>(linearPhase.getLatencySamples() - oversamplingLatencies[activeOversampling]));
+
+	for (size_t ch = 0; ch < numChannels; ++ch)
+	{
+		auto* samples = block.getChannelPointer(ch);
+
+		for (size_t i = 0; i < numSamples; ++i)
+		{
+			iirDelay.pushSample(static_cast<int>(ch), samples[i]);
+			const auto delayedSample = iirDelay.popSample(static_cast<int>(ch));
+
+			if (delayed)
+				samples[i] = delayedSample;
+		}
+	}
+
+	if (pathFade.isSmoothing())
+	{
+		for (size_t i = 0; i < numSamples; ++i)
+			fadeGains[i] = pathFade.getNextValue();
+
+		//iir + (linear - iir) * gain
+		for (size_t ch = 0; ch < numChannels; ++ch)
+		{
+			auto* output = block.getChannelPointer(ch);
+			auto* linear = linearBlock.getChannelPointer(ch);
+
+			juce::FloatVectorOperations::subtract(linear, output, static_cast<int>(numSamples));
+			juce::FloatVectorOperations::multiply(linear, fadeGains.data(), static_cast<int>(numSamples));
+			juce::FloatVectorOperations::add(output, linear, static_cast<int>(numSamples));
+		}
+	}
+	else if (linearPhaseAudible)
+	{
+		block.copyFrom(linearBlock);
+	}
+
+	//faded all the way back, the IIR chain goes on alone and undelayed
+	if (!wantsLinearPhase && !pathFade.isSmoothing())
+		linearPhaseRunning = false;
+
+	updateLatency();
+}
+
+void AudioPluginAudioProcessor::processIIR(juce::dsp::AudioBlock<float>& block)
+{
+	if (activeOversampler == nullptr)
+	{
+		processChain(block);
+		return;
+	}
+
+	processChain(activeOversampler->processSamplesUp(block));
+	activeOversampler->processSamplesDown(block);
+}
+
+void AudioPluginAudioProcessor::processChain(const juce::dsp::AudioBlock<float>& block)
+{
+	if (!crossfade.isSmoothing())
+	{
+		processLive(block);
+		return;
+	}
+
+	const auto numChannels = juce::jmin(block.getNumChannels(), static_cast<size_t>(fadeBuffer.getNumChannels()));
+	const auto numSamples = block.getNumSamples();
+
+	juce::dsp::AudioBlock<float> fadeBlock(fadeBuffer.getArrayOfWritePointers(), numChannels, numSamples);
+	fadeBlock.copyFrom(block);
+	fadingChain.process(fadeBlock);
+
+	processLive(block);
+
+	for (size_t i = 0; i < numSamples; ++i)
+		fadeGains[i] = crossfade.getNextValue();
+
+	//new * gain + old * (1 - gain), done as old + (new - old) * gain
+	for (size_t ch = 0; ch < numChannels; ++ch)
+	{
+		auto* output = block.getChannelPointer(ch);
+		auto* previous = fadeBlock.getChannelPointer(ch);
+
+		juce::FloatVectorOperations::subtract(output, previous, static_cast<int>(numSamples));
+		juce::FloatVectorOperations::multiply(output, fadeGains.data(), static_cast<int>(numSamples));
+		juce::FloatVectorOperations::add(output, previous, static_cast<int>(numSamples));
+	}
+}
+
+void AudioPluginAudioProcessor::processLive(const juce::dsp::AudioBlock<float>& block)
+{
+	//ramps to new designs run per sample inside the chain, only the dynamic peak needs the
+	//block cut up. It steps at the same rate in time, whatever the oversampling
+	if (!dynamicActive)
+	{
+		chain.process(block);
+		return;
+	}
+
+	const auto numSamples = static_cast<int>(block.getNumSamples());
+	const auto interval = dynamicPeak.getControlInterval();
+
+	//listens where the running set puts the band, which may still be behind the parameters
+	dynamicPeak.setPlacement(chain.getStereoMode(), chain.getBandChannel(0));
+
+	for (int start = 0; start < numSamples; start += interval)
+	{
+		const auto length = juce::jmin(interval, numSamples - start);
+		const auto piece = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(length));
+
+		chain.setBandCoefficients(0, dynamicPeak.process(piece)); //measured on the input of this very piece
+		chain.process(piece);
+	}
+}
+
+void AudioPluginAudioProcessor::updateDynamics() noexcept
+{
+	const auto& peak = bandParams[0];
+	const auto type = static_cast<BandType>(static_cast<int>(peak.type->load()));
+
+	//a notch or band pass has no gain to move
+	const auto shouldBeDynamic = peakDynamicParam->load() > 0.5f && peak.enabled->load() > 0.5f && hasGain(type);
+
+	if (shouldBeDynamic != dynamicActive)
+	{
+		dynamicActive = shouldBeDynamic;
+
+		if (dynamicActive)
+			dynamicPeak.reset(); //starts at 0 dB and follows the level from here
+		else
+			chain.releaseBand(0, rampSamples); //glides back to the static peak
+	}
+
+	if (!dynamicActive)
+		return;
+
+	DynamicPeak::Settings settings;
+	settings.type = type;
+	settings.frequency = peak.frequency->load();
+	settings.quality = peak.quality->load();
+	settings.rangeInDecibels = peak.gain->load();
+	settings.thresholdInDecibels = peakThresholdParam->load();
+	settings.ratio = peakRatioParam->load();
+	settings.attackMs = peakAttackParam->load();
+	settings.releaseMs = peakReleaseParam->load();
+
+	dynamicPeak.setSettings(settings);
+}
+
+void AudioPluginAudioProcessor::switchOversampling(const ChainCoefficients& chainCoefficients)
+{
+	//the designer only publishes a new rate after the oversampling factor changed, so the set
+	//tells us which oversampler to run. There is nothing to glide from at a different rate
+	const auto factor = juce::roundToInt(chainCoefficients.sampleRate / baseSampleRate);
+	const auto index = factor >= 4 ? Oversampling_4x : (factor == 2 ? Oversampling_2x : Oversampling_Off);
+
+	activeOversampling = index;
+	activeOversampler = oversamplers[index].get();
+
+	if (activeOversampler != nullptr)
+		activeOversampler->reset();
+
+	chainSampleRate = chainCoefficients.sampleRate;
+	rampSamples = juce::roundToInt(chainSampleRate * rampSeconds);
+	updateLatency();
+
+	chain.reset();
+	chain.setCoefficients(chainCoefficients);
+
+	crossfade.reset(chainCoefficients.sampleRate, crossfadeSeconds);
+	crossfade.setCurrentAndTargetValue(1.f);
+
+	dynamicPeak.setSampleRate(chainCoefficients.sampleRate, DynamicPeak::hostControlInterval << index);
+}
+
+void AudioPluginAudioProcessor::switchProgram(const ChainCoefficients& chainCoefficients)
+{
+	//the old chain carries on from where it is and fades out, the live chain keeps its
+	//states and jumps straight to the preset, so neither output has a discontinuity
+	fadingChain.copyFrom(chain);
+
+	//presets only carry the bands, where they sit comes from the parameters
+	programCoefficients = chainCoefficients;
+	applyStereoMode(programCoefficients, getCachedChainSettings());
+
+	chain.setCoefficients(programCoefficients);
+
+	crossfade.setCurrentAndTargetValue(0.f);
+	crossfade.setTargetValue(1.f);
+}
+
+void AudioPluginAudioProcessor::applyPresetSettings(const ChainSettings& chainSettings)
+{
+	auto setParameter = [this](const juce::String& parameterID, float value)
+	{
+		auto* parameter = apvts.getParameter(parameterID);
+		const auto normalised = parameter->convertTo0to1(value);
+
+		if (normalised != parameter->getValue())
+			parameter->setValueNotifyingHost(normalised);
+	};
+
+	//oversampling and linear phase are left alone, presets only carry the bands
+	setParameter("LowCut Freq", chainSettings.lowCutFreq);
+	setParameter("LowCut Slope", static_cast<float>(chainSettings.lowCutSlope));
+
+	for (int band = 0; band < maxBands; ++band)
+	{
+		const auto& settings = chainSettings.bands[static_cast<size_t>(band)];
+
+		setParameter(getBandParameterID(band, "Enabled"), settings.enabled ? 1.f : 0.f);
+
+		if (!settings.enabled) //a band that is off keeps whatever it was set to
+			continue;
+
+		setParameter(getBandParameterID(band, "Type"), static_cast<float>(settings.type));
+		setParameter(getBandParameterID(band, "Freq"), settings.frequency);
+		setParameter(getBandParameterID(band, "Gain"), settings.gainInDecibels);
+		setParameter(getBandParameterID(band, "Quality"), settings.quality);
+	}
+	setParameter("HighCut Freq", chainSettings.highCutFreq);
+	setParameter("HighCut Slope", static_cast<float>(chainSettings.highCutSlope));
+}
+
+void AudioPluginAudioProcessor::handleNewDesign(const ChainSettings& chainSettings, const ChainCoefficients& chainCoefficients)
+{
+	if (chainSettings.linearPhase)
+		linearPhase.setTarget(chainCoefficients);
+
+	updateTail(chainSettings, chainCoefficients);
+}
+
+void AudioPluginAudioProcessor::updateLatency() noexcept
+{
+	//linear phase counts from the moment it starts fading in until it has faded out completely, the IIR
+	//chain is delayed to match for all of that time
+	const auto linearPhaseHeard = linearPhaseRunning && (linearPhaseAudible || pathFade.getCurrentValue() > 0.f);
+	runningLatency.store(linearPhaseHeard ? linearPhase.getLatencySamples() : oversamplingLatencies[activeOversampling],
+		std::memory_order_relaxed);
+
+	if (designPerBlock) //offline nothing runs in real time, the host can be told from here
+		reportLatency();
+}
+
+void AudioPluginAudioProcessor::reportLatency()
+{
+	const auto latency = runningLatency.load(std::memory_order_relaxed);
+
+	if (latency != getLatencySamples())
+		setLatencySamples(latency);
+}
+
+void AudioPluginAudioProcessor::timerCallback()
+{
+	reportLatency();
+}
 
-	juce::dsp::AudioBlock<float> block(buffer);
-	auto leftBlock = block.getSingleChannelBlock(0); 
-	auto rightBlock = block.getSingleChannelBlock(1);
+void AudioPluginAudioProcessor::updateTail(const ChainSettings& chainSettings, const ChainCoefficients& chainCoefficients)
+{
+	if (baseSampleRate <= 0.0)
+		return;
 
-	juce::dsp::ProcessContextReplacing<float> leftContext(leftBlock);
-	juce::dsp::ProcessContextReplacing<float> rightContext(rightBlock);
+	//the IIR chain rings for as long as its slowest poles take to decay, delayed by the oversampling
+	//filters. The linear phase kernel is windowed, so its tail is simply its length, latency included,
+	//but the IIR chain stands in for it until the first kernel is loaded
+	auto seconds = getDecayTimeSeconds(chainCoefficients, tailDecayDecibels)
+		+ oversamplingLatencies[chainSettings.oversampling] / baseSampleRate;
 
-	leftChain.process(leftContext);//sending buffer blocks to different channels
-	rightChain.process(rightContext);
+	if (chainSettings.linearPhase)
+		seconds = juce::jmax(seconds, 2 * linearPhase.getLatencySamples() / baseSampleRate);
 
+	tailSeconds = seconds;
+	tailSamples = static_cast<int>(std::ceil(seconds * baseSampleRate));
 }
 
 //==============================================================================
@@ -191,12 +687,17 @@ void AudioPluginAudioProcessor::getStateInformation (juce::MemoryBlock& destData
     // You should use this method to store your parameters in the memory block.
     // You could do that either as raw data, or use the XML or ValueTree classes
     // as intermediaries to make it easy to save and load complex data.
+	PluginState::write(*this, destData);
 }
 
 void AudioPluginAudioProcessor::setStateInformation (const void* data, int sizeInBytes)
 {
     // You should use this method to restore your parameters from this memory block,
     // whose contents will have been created by the getStateInformation() call.
+	//one pass over the restored values instead of waiting for the designer to notice. Offline the
+	//next block designs them anyway, and designing here would hold the audio thread up on designLock
+	if (PluginState::read(*this, data, sizeInBytes) && !designPerBlock)
+		designer.designNow();
 }
 ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
 {	
@@ -204,75 +705,60 @@ ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts)
 
 	settings.lowCutFreq= apvts.getRawParameterValue("LowCut Freq")->load();
 	settings.highCutFreq= apvts.getRawParameterValue("HighCut Freq")->load();
-	settings.peakFreq= apvts.getRawParameterValue("Peak Freq")->load();
-	settings.peakGainInDecibels= apvts.getRawParameterValue("Peak Gain")->load();
-	settings.peakQuality=apvts.getRawParameterValue("Peak Quality")->load();
+
+	for (int band = 0; band < maxBands; ++band)
+	{
+		auto& bandSettings = settings.bands[static_cast<size_t>(band)];
+		bandSettings.enabled = apvts.getRawParameterValue(getBandParameterID(band, "Enabled"))->load() > 0.5f;
+		bandSettings.type = static_cast<BandType>(static_cast<int>(apvts.getRawParameterValue(getBandParameterID(band, "Type"))->load()));
+		bandSettings.frequency = apvts.getRawParameterValue(getBandParameterID(band, "Freq"))->load();
+		bandSettings.gainInDecibels = apvts.getRawParameterValue(getBandParameterID(band, "Gain"))->load();
+		bandSettings.quality = apvts.getRawParameterValue(getBandParameterID(band, "Quality"))->load();
+		bandSettings.channel = static_cast<BandChannel>(static_cast<int>(apvts.getRawParameterValue(getBandParameterID(band, "Channel"))->load()));
+	}
+
 	settings.lowCutSlope = static_cast<Slope>(static_cast<int>(apvts.getRawParameterValue("LowCut Slope")->load()));
 	settings.highCutSlope = static_cast<Slope>(static_cast<int>(apvts.getRawParameterValue("HighCut Slope")->load()));
+	settings.oversampling = static_cast<Oversampling>(static_cast<int>(apvts.getRawParameterValue("Oversampling")->load()));
+	settings.linearPhase = apvts.getRawParameterValue("Linear Phase")->load() > 0.5f;
+	settings.stereoMode = static_cast<StereoMode>(static_cast<int>(apvts.getRawParameterValue("Stereo Mode")->load()));
+	settings.lowCutChannel = static_cast<BandChannel>(static_cast<int>(apvts.getRawParameterValue("LowCut Channel")->load()));
+	settings.highCutChannel = static_cast<BandChannel>(static_cast<int>(apvts.getRawParameterValue("HighCut Channel")->load()));
 	
 	//apvts.getParameter("LowCut Freq")->getValue();
 
 	return settings;
 }
 
-void AudioPluginAudioProcessor::updatePeakFilter(const ChainSettings &chainSettings)
-{
-	auto peakCoefficients = juce::dsp::IIR::Coefficients<float>::makePeakFilter(getSampleRate(),
-		chainSettings.peakFreq,
-		chainSettings.peakQuality,
-		juce::Decibels::decibelsToGain(chainSettings.peakGainInDecibels));
-
-	updateCoefficients(leftChain.get<ChainPosition::Peak>().coefficients, peakCoefficients);
-	updateCoefficients(rightChain.get<ChainPosition::Peak>().coefficients, peakCoefficients);
-}
-
-void AudioPluginAudioProcessor::updateCoefficients(Coefficients& old, const Coefficients& replacements)
-{
-	*old = *replacements;
-}
-
-
-
-
-void AudioPluginAudioProcessor::updateLowCutFilters(const ChainSettings &chainSettings)
-{
-	auto cutCoefficients = juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(chainSettings.lowCutFreq,
-		getSampleRate(),
-		2 * (chainSettings.lowCutSlope + 1));
-
-	auto& leftLowCut = leftChain.get<ChainPosition::LowCut>();
-	auto& rightLowCut = rightChain.get<ChainPosition::LowCut>();
-
-	updateCutFilter(leftLowCut, cutCoefficients, chainSettings.lowCutSlope);
-	updateCutFilter(rightLowCut, cutCoefficients, chainSettings.lowCutSlope);
-	
-	
-}
-
-
-
-void AudioPluginAudioProcessor::updateHighCutFilters(const ChainSettings &chainSettings)
+ChainSettings AudioPluginAudioProcessor::getCachedChainSettings() const
 {
-	auto highCutCoefficients = juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(chainSettings.highCutFreq,
-		getSampleRate(),
-		2 * (chainSettings.highCutSlope + 1));
-	
-	auto& rightHighCut = rightChain.get<ChainPosition::HighCut>();
-	auto& leftHighCut = leftChain.get<ChainPosition::HighCut>();
+	ChainSettings settings;
 
-	updateCutFilter(rightHighCut, highCutCoefficients, chainSettings.highCutSlope);
-	updateCutFilter(leftHighCut, highCutCoefficients, chainSettings.highCutSlope);
-
-}
+	settings.lowCutFreq = lowCutFreqParam->load();
+	settings.highCutFreq = highCutFreqParam->load();
 
+	for (int band = 0; band < maxBands; ++band)
+	{
+		const auto& params = bandParams[static_cast<size_t>(band)];
+		auto& bandSettings = settings.bands[static_cast<size_t>(band)];
+
+		bandSettings.enabled = params.enabled->load() > 0.5f;
+		bandSettings.type = static_cast<BandType>(static_cast<int>(params.type->load()));
+		bandSettings.frequency = params.frequency->load();
+		bandSettings.gainInDecibels = params.gain->load();
+		bandSettings.quality = params.quality->load();
+		bandSettings.channel = static_cast<BandChannel>(static_cast<int>(params.channel->load()));
+	}
 
-void AudioPluginAudioProcessor::updateFilters()
-{
-	auto chainSettings = getChainSettings(apvts);
+	settings.lowCutSlope = static_cast<Slope>(static_cast<int>(lowCutSlopeParam->load()));
+	settings.highCutSlope = static_cast<Slope>(static_cast<int>(highCutSlopeParam->load()));
+	settings.oversampling = static_cast<Oversampling>(static_cast<int>(oversamplingParam->load()));
+	settings.linearPhase = linearPhaseParam->load() > 0.5f;
+	settings.stereoMode = static_cast<StereoMode>(static_cast<int>(stereoModeParam->load()));
+	settings.lowCutChannel = static_cast<BandChannel>(static_cast<int>(lowCutChannelParam->load()));
+	settings.highCutChannel = static_cast<BandChannel>(static_cast<int>(highCutChannelParam->load()));
 
-	updateLowCutFilters(chainSettings);
-	updateHighCutFilters(chainSettings);
-	updatePeakFilter(chainSettings);
+	return settings;
 }
 
 juce::AudioProcessorValueTreeState::ParameterLayout
@@ -317,6 +803,79 @@ juce::AudioProcessorValueTreeState::ParameterLayout
 
 	layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Slope","LowCut Slope", stringArray, 0));
 	layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Slope", "HighCut Slope", stringArray, 0));
+
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Oversampling", "Oversampling", juce::StringArray{ "Off", "2x", "4x" }, 0));
+	layout.add(std::make_unique<juce::AudioParameterBool>("Linear Phase", "Linear Phase", false));
+
+	//dynamic mode of the peak band, Peak Gain then sets how far the band may move
+	layout.add(std::make_unique<juce::AudioParameterBool>("Peak Dynamic", "Peak Dynamic", false));
+
+	layout.add(std::make_unique<juce::AudioParameterFloat>(	"Peak Threshold",
+															"Peak Threshold",
+															juce::NormalisableRange<float>(-60.f, 0.f, 0.5f, 1.f),
+															-24.f));
+
+	layout.add(std::make_unique<juce::AudioParameterFloat>(	"Peak Ratio",
+															"Peak Ratio",
+															juce::NormalisableRange<float>(1.f, 20.f, 0.1f, 0.4f),
+															2.f));
+
+	layout.add(std::make_unique<juce::AudioParameterFloat>(	"Peak Attack",
+															"Peak Attack",
+															juce::NormalisableRange<float>(0.1f, 200.f, 0.1f, 0.3f),
+															10.f));
+
+	layout.add(std::make_unique<juce::AudioParameterFloat>(	"Peak Release",
+															"Peak Release",
+															juce::NormalisableRange<float>(5.f, 2000.f, 1.f, 0.3f),
+															150.f));
+
+	//more bands after the cuts and the dynamics, so every parameter keeps its index for hosts that go by position
+	const juce::StringArray bandTypes{ "Peak", "Low Shelf", "High Shelf", "Notch", "Band Pass" }; //in BandType order
+
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Peak Type", "Peak Type", bandTypes, Band_Peak));
+	layout.add(std::make_unique<juce::AudioParameterBool>("Peak Enabled", "Peak Enabled", true));
+
+	//the extra bands start switched off and spread over the spectrum, so turning one on doesn't land it on the peak band
+	const float bandFrequencies[maxBands] = { 750.f, 60.f, 150.f, 400.f, 1500.f, 3000.f, 6000.f, 12000.f };
+
+	for (int band = 1; band < maxBands; ++band)
+	{
+		const auto name = "Band " + juce::String(band + 1) + " ";
+
+		layout.add(std::make_unique<juce::AudioParameterFloat>(	getBandParameterID(band, "Freq"),
+																name + "Frequency",
+																juce::NormalisableRange<float>(20.f, 20000.f, 1.f, 0.25f),
+																bandFrequencies[band]));
+
+		layout.add(std::make_unique<juce::AudioParameterFloat>(	getBandParameterID(band, "Gain"),
+																name + "Gain",
+																juce::NormalisableRange<float>(-24.f, 24.f, 0.5f, 1.f),
+																0.0f));
+
+		layout.add(std::make_unique<juce::AudioParameterFloat>(	getBandParameterID(band, "Quality"),
+																name + "Quality",
+																juce::NormalisableRange<float>(0.1f, 10.f, 0.05f, 1.f),
+																1.f));
+
+		layout.add(std::make_unique<juce::AudioParameterChoice>(getBandParameterID(band, "Type"), name + "Type", bandTypes, Band_Peak));
+		layout.add(std::make_unique<juce::AudioParameterBool>(getBandParameterID(band, "Enabled"), name + "Enabled", false));
+	}
+
+	//stereo modes, in the IIR modes only: the linear phase kernel runs every band on every channel.
+	//Outside of the linked mode each band and cut runs on the channels it is placed on
+	layout.add(std::make_unique<juce::AudioParameterChoice>("Stereo Mode", "Stereo Mode", juce::StringArray{ "Linked", "Left/Right", "Mid/Side" }, Stereo_Linked));
+
+	const juce::StringArray channels{ "Both", "Left/Mid", "Right/Side" }; //in BandChannel order
+
+	layout.add(std::make_unique<juce::AudioParameterChoice>("LowCut Channel", "LowCut Channel", channels, Channel_Both));
+	layout.add(std::make_unique<juce::AudioParameterChoice>("HighCut Channel", "HighCut Channel", channels, Channel_Both));
+
+	for (int band = 0; band < maxBands; ++band)
+	{
+		const auto name = band == 0 ? juce::String("Peak ") : "Band " + juce::String(band + 1) + " ";
+		layout.add(std::make_unique<juce::AudioParameterChoice>(getBandParameterID(band, "Channel"), name + "Channel", channels, Channel_Both));
+	}
 	
 
 	
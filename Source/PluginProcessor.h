@@ -9,30 +9,21 @@
 #pragma once
 
 #include <JuceHeader.h>
-
-enum Slope //C++ doesnt allow numbers as VariableIdentifiers so i made an enum to correctly say what the variable represents
-{
-	Slope_12,
-	Slope_24,
-	Slope_36,
-	Slope_48
-};
-
-struct ChainSettings //all Parameters added
-{
-	float peakFreq{ 0 }, peakGainInDecibels{ 0 }, peakQuality{ 1.f };
-	float lowCutFreq{ 0 }, highCutFreq{ 0 };
-
-	Slope lowCutSlope{ Slope::Slope_12 }, highCutSlope{ Slope::Slope_12 };
-}; 
-
-ChainSettings getChainSettings(juce::AudioProcessorValueTreeState& apvts);
-
+#include "ChainSettings.h"
+#include "CoefficientDesigner.h"
+#include "EqualizerChain.h"
+#include "LinearPhaseEqualizer.h"
+#include "DynamicPeak.h"
+#include "AnalyzerFifo.h"
+#include "PresetBank.h"
+#include "PerformanceMonitor.h"
+#include "RealtimeGuard.h"
 
 //==============================================================================
 /**
 */
-class AudioPluginAudioProcessor  : public juce::AudioProcessor
+class AudioPluginAudioProcessor  : public juce::AudioProcessor,
+                                   private juce::Timer
 {
 public:
     //==============================================================================
@@ -78,72 +69,139 @@ public:
 		createParameterLayout();
 
 	juce::AudioProcessorValueTreeState apvts { *this, nullptr, "Parameters", createParameterLayout()};
-		
-private:
 
-	using Filter = juce::dsp::IIR::Filter<float>;
+	//feeds the editor's spectrum analyzer, processBlock only pushes while analyzerActive is set
+	AnalyzerFifo preAnalyzerFifo, postAnalyzerFifo;
+	std::atomic<bool> analyzerActive{ false };
 
-	using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+	//timing of every processBlock, read by the editor
+	PerformanceMonitor performance;
 
-	using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+	//true while linear phase is on but its kernel isn't in yet, the IIR chain stands in for it until
+	//then. Offline the kernel is loaded in prepareToPlay, so there this only stays true if that failed
+	bool isLinearPhasePending() const noexcept { return linearPhaseParam->load() > 0.5f && !linearPhase.isReady(); }
 
-	MonoChain leftChain, rightChain;
+	//moves the parameters to a preset without switching programs on the audio thread, for offline
+	//renders that set everything up before the first block
+	void loadPresetParameters(int index);
+		
+private:
 
-	enum ChainPosition { //3-Band equalizer therefor 3 values
-		LowCut,
-		Peak,
-		HighCut
+	EqualizerChain chain; //every channel runs in a lane of one of the pooled SIMD engines
+
+	//a new set is taken as an event at the start of the block and ramped to per sample inside the
+	//engines. The ramp lasts the same time at any host rate and oversampling factor. Offline the set
+	//is designed in processBlock from the block's parameters and the ramp spans that block instead
+	static constexpr double rampSeconds = 0.02;
+	double chainSampleRate{ 0.0 };
+	int rampSamples{ 0 };
+	std::atomic<bool> designPerBlock{ false };	//prepared for non-realtime use, also read by setStateInformation
+
+	//after a program change the previous chain keeps running on a copy of the input and fades out
+	EqualizerChain fadingChain;
+	juce::AudioBuffer<float> fadeBuffer;
+	std::vector<float> fadeGains;
+	juce::SmoothedValue<float> crossfade;
+	static constexpr double crossfadeSeconds = 0.03;
+
+	//one oversampler per factor, all built in prepareToPlay so switching never allocates
+	std::array<std::unique_ptr<juce::dsp::Oversampling<float>>, 3> oversamplers;
+	std::array<int, 3> oversamplingLatencies{};
+	juce::dsp::Oversampling<float>* activeOversampler{ nullptr };
+	Oversampling activeOversampling{ Oversampling_Off };
+	double baseSampleRate{ 0.0 };
+
+	//once the input has been silent for longer than the current tail nothing is ringing any more, the
+	//filters are skipped and their states flushed until sound comes back, so they never decay into denormals
+	bool updateIdleState(const juce::AudioBuffer<float>& buffer);
+	void flushStates() noexcept;
+	static constexpr float silenceThreshold = 1.0e-6f;		//-120 dBFS, quieter input counts as silence
+	static constexpr double tailDecayDecibels = 120.0;		//the tail lasts until the response has fallen this far
+	int silentSamples{ 0 };
+	bool idle{ false };
+
+	//worked out from the poles of every new design, on the designer thread
+	std::atomic<double> tailSeconds{ 0.0 };
+	std::atomic<int> tailSamples{ 0 };						//at the host rate
+
+	//the peak band follows its own level while "Peak Dynamic" is on, in the IIR modes only and
+	//as long as the band is on and of a type that has a gain
+	DynamicPeak dynamicPeak;
+	bool dynamicActive{ false };
+	void updateDynamics() noexcept;
+
+	//while linear phase is on the convolutions are fed whether they are heard or not, that is how
+	//the kernel gets swapped in and how isReady() knows it is
+	bool linearPhaseRunning{ false };
+	juce::AudioBuffer<float> linearPhaseBuffer;
+
+	//the IIR chain and linear phase are crossfaded, never cut. The IIR chain keeps running under the
+	//linear phase path, and while linear phase is heard at all its output is delayed by the difference
+	//in latency so the two line up. The delay is always fed, so it has the past ready when it's switched in
+	bool linearPhaseAudible{ false };
+	juce::SmoothedValue<float> pathFade;	//0 is the IIR chain, 1 linear phase
+	juce::dsp::DelayLine<float, juce::dsp::DelayLineInterpolationTypes::None> iirDelay;
+
+	//the latency of the path that is actually heard. The audio thread works it out, the host is told
+	//from the message thread, or right away offline
+	std::atomic<int> runningLatency{ 0 };
+	static constexpr int latencySyncIntervalMs = 50;
+	void updateLatency() noexcept;
+	void reportLatency();
+	void timerCallback() override;
+
+	void processEqualizer(juce::dsp::AudioBlock<float>& block);
+	void processIIR(juce::dsp::AudioBlock<float>& block);
+	void processChain(const juce::dsp::AudioBlock<float>& block);
+	void processLive(const juce::dsp::AudioBlock<float>& block);
+	void switchOversampling(const ChainCoefficients& chainCoefficients);
+	void switchProgram(const ChainCoefficients& chainCoefficients);
+
+	//a preset's set split up the way the current stereo parameters place the bands, ready for the chain
+	ChainCoefficients programCoefficients;
+
+	//message thread, moves the parameters to a preset's values
+	void applyPresetSettings(const ChainSettings& chainSettings);
+	void updateTail(const ChainSettings& chainSettings, const ChainCoefficients& chainCoefficients);
+
+	//designer thread after every published set, the audio thread when designing per block
+	void handleNewDesign(const ChainSettings& chainSettings, const ChainCoefficients& chainCoefficients);
+
+	ChainSettings getCachedChainSettings() const;
+
+	//raw parameter values looked up once in the constructor instead of by name every block
+	std::atomic<float>* lowCutFreqParam{ nullptr };
+	std::atomic<float>* highCutFreqParam{ nullptr };
+	std::atomic<float>* lowCutSlopeParam{ nullptr };
+	std::atomic<float>* highCutSlopeParam{ nullptr };
+	std::atomic<float>* oversamplingParam{ nullptr };
+	std::atomic<float>* linearPhaseParam{ nullptr };
+	std::atomic<float>* peakDynamicParam{ nullptr };
+	std::atomic<float>* peakThresholdParam{ nullptr };
+	std::atomic<float>* peakRatioParam{ nullptr };
+	std::atomic<float>* peakAttackParam{ nullptr };
+	std::atomic<float>* peakReleaseParam{ nullptr };
+	std::atomic<float>* stereoModeParam{ nullptr };
+	std::atomic<float>* lowCutChannelParam{ nullptr };
+	std::atomic<float>* highCutChannelParam{ nullptr };
+
+	struct BandParams
+	{
+		std::atomic<float>* enabled{ nullptr };
+		std::atomic<float>* type{ nullptr };
+		std::atomic<float>* frequency{ nullptr };
+		std::atomic<float>* gain{ nullptr };
+		std::atomic<float>* quality{ nullptr };
+		std::atomic<float>* channel{ nullptr };
 	};
 
-	void updatePeakFilter(const ChainSettings& chainSettings);
-	using Coefficients = Filter::CoefficientsPtr;
+	std::array<BandParams, maxBands> bandParams;	//band 0 is the peak band
 
-	static void updateCoefficients(Coefficients& old, const Coefficients& replacements);
-
-	template<int index, typename ChainType, typename CoefficientType>
-	void update(ChainType& chain, const CoefficientType& coefficients)
-	{
-		updateCoefficients(chain.template get<index>().coefficients, coefficients[index]);
-		chain.template setBypassed<index>(false);
-	};
-	
-	template<typename ChainType, typename CoefficientType>
-	void updateCutFilter(	ChainType& chain,
-							const CoefficientType& cutCoefficients,
-							const Slope& Slope)
-	{
-		chain.setBypassed<0>(true);
-		chain.setBypassed<1>(true);
-		chain.setBypassed<2>(true);
-		chain.setBypassed<3>(true);
-
-		switch (Slope) {							//whatever Case is beeing triggered also executes the cases below
-
-			case Slope_48:
-			{
-				update<3>(chain, cutCoefficients);	//hardest Possible Cut 
-			}
-		case Slope_36:
-			{
-				update<2>(chain, cutCoefficients);
-			}
-
-		case Slope_24:
-			{
-				update<1>(chain, cutCoefficients);
-			}
-		case Slope_12:
-			{ 
-				update<0>(chain, cutCoefficients);	//softest Possible Cut
-			}	
-		}
-	
-	};
+	LinearPhaseEqualizer linearPhase; //fed by the designer, so it has to outlive it
 
+	CoefficientDesigner designer{ [this] { return getCachedChainSettings(); } };
 
-	void updateLowCutFilters(const ChainSettings& chainSettings);
-	void updateHighCutFilters(const ChainSettings& chainSettings);
-	void updateFilters();
+	PresetBank presets{ [this](const ChainSettings& chainSettings) { applyPresetSettings(chainSettings); } };
 	
 
     //==============================================================================
@@ -0,0 +1,153 @@
+/*
+  ==============================================================================
+
+    Binary plugin state.
+
+  ==============================================================================
+*/
+
+#include "PluginState.h"
+
+namespace
+{
+	constexpr juce::uint32 magic = 0x54535145; //"EQST" when read as bytes
+	constexpr juce::uint16 currentVersion = 1;
+	constexpr juce::uint16 currentEntrySize = 8;
+	constexpr int headerSize = 12;
+
+	//FNV-1a over the UTF-8 ID, unlike String::hashCode this is guaranteed never to change between JUCE versions
+	juce::uint32 hashParameterID(const juce::String& parameterID)
+	{
+		juce::uint32 hash = 2166136261u;
+
+		for (auto* c = parameterID.toRawUTF8(); *c != 0; ++c)
+		{
+			hash ^= static_cast<juce::uint8>(*c);
+			hash *= 16777619u;
+		}
+
+		return hash;
+	}
+
+	juce::RangedAudioParameter* asRanged(juce::AudioProcessorParameter* parameter)
+	{
+		auto* ranged = dynamic_cast<juce::RangedAudioParameter*>(parameter);
+		jassert(ranged != nullptr); //every parameter comes from the APVTS layout
+		return ranged;
+	}
+}
+
+void PluginState::checkParameterIDs(const juce::AudioProcessor& processor)
+{
+   #if JUCE_DEBUG
+	std::vector<juce::uint32> hashes;
+
+	for (auto* parameter : processor.getParameters())
+		hashes.push_back(hashParameterID(asRanged(parameter)->paramID));
+
+	std::sort(hashes.begin(), hashes.end());
+
+	//a collision would load one parameter's value into the other, rename one of them
+	jassert(std::adjacent_find(hashes.begin(), hashes.end()) == hashes.end());
+   #else
+	juce::ignoreUnused(processor);
+   #endif
+}
+
+void PluginState::write(const juce::AudioProcessor& processor, juce::MemoryBlock& destData)
+{
+	const auto& parameters = processor.getParameters();
+
+	destData.setSize(static_cast<size_t>(headerSize + parameters.size() * currentEntrySize));
+	juce::MemoryOutputStream stream(destData, false);
+
+	stream.writeInt(static_cast<int>(magic));
+	stream.writeShort(static_cast<short>(currentVersion));
+	stream.writeShort(static_cast<short>(currentEntrySize));
+	stream.writeInt(parameters.size());
+
+	for (auto* parameter : parameters)
+	{
+		auto* ranged = asRanged(parameter);
+
+		stream.writeInt(static_cast<int>(hashParameterID(ranged->paramID)));
+		stream.writeFloat(ranged->convertFrom0to1(ranged->getValue()));
+	}
+}
+
+bool PluginState::read(juce::AudioProcessor& processor, const void* data, int sizeInBytes)
+{
+	if (data == nullptr || sizeInBytes < headerSize)
+		return false;
+
+	auto* bytes = static_cast<const char*>(data);
+
+	if (juce::ByteOrder::littleEndianInt(bytes) != magic)
+		return false;
+
+	const auto version = juce::ByteOrder::littleEndianShort(bytes + 4);
+	const auto entrySize = static_cast<int>(juce::ByteOrder::littleEndianShort(bytes + 6));
+	const auto numEntries = static_cast<int>(juce::ByteOrder::littleEndianInt(bytes + 8));
+
+	//a newer version may add records, but the record layout itself is fixed
+	if (version < 1 || entrySize < currentEntrySize || numEntries < 0
+		|| numEntries > (sizeInBytes - headerSize) / entrySize)
+		return false;
+
+	const auto& parameters = processor.getParameters();
+	const auto numParameters = parameters.size();
+
+	std::vector<juce::uint32> hashes;
+	hashes.reserve(static_cast<size_t>(numParameters));
+
+	for (auto* parameter : parameters)
+		hashes.push_back(hashParameterID(asRanged(parameter)->paramID));
+
+	std::vector<float> values(static_cast<size_t>(numParameters));
+	std::vector<bool> found(static_cast<size_t>(numParameters), false);
+
+	//states are written in parameter order, so the lookup almost always hits on the first try
+	int hint = 0;
+
+	for (int entry = 0; entry < numEntries; ++entry)
+	{
+		auto* record = bytes + headerSize + entry * entrySize;
+		const auto hash = juce::ByteOrder::littleEndianInt(record);
+
+		for (int tries = 0; tries < numParameters; ++tries)
+		{
+			const auto index = (hint + tries) % numParameters;
+
+			if (hashes[static_cast<size_t>(index)] != hash)
+				continue;
+
+			const auto bits = juce::ByteOrder::littleEndianInt(record + 4);
+			float value;
+			std::memcpy(&value, &bits, sizeof(float));
+
+			if (std::isfinite(value))
+			{
+				values[static_cast<size_t>(index)] = value;
+				found[static_cast<size_t>(index)] = true;
+			}
+
+			hint = index + 1;
+			break;
+		}
+	}
+
+	for (int index = 0; index < numParameters; ++index)
+	{
+		auto* ranged = asRanged(parameters[index]);
+
+		const auto normalised = found[static_cast<size_t>(index)]
+			? ranged->convertTo0to1(values[static_cast<size_t>(index)])
+			: ranged->getDefaultValue();
+
+		//the APVTS atomics update synchronously, unchanged ones don't bother the host
+		if (normalised != ranged->getValue())
+			ranged->setValueNotifyingHost(normalised);
+	}
+
+	return true;
+}
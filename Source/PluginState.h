@@ -0,0 +1,34 @@
+/*
+  ==============================================================================
+
+    Binary plugin state. Every parameter is stored as a fixed size record of
+    a hash of its ID and its plain (not normalised) value:
+
+        uint32  magic           'EQST'
+        uint16  version
+        uint16  entry size      bytes per record, at least 8
+        uint32  entry count
+        entries                 uint32 ID hash, float32 value, then padding up to the entry size
+
+    all little endian. Records with IDs this build doesn't know are skipped and
+    records may grow, so states from newer builds with more bands still load.
+    Parameters missing from a state go back to their defaults.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace PluginState
+{
+	//debug builds only, asserts that no two parameter IDs hash the same. Called once at construction,
+	//so a new parameter whose ID collides is caught the first time the plugin runs
+	void checkParameterIDs(const juce::AudioProcessor& processor);
+
+	void write(const juce::AudioProcessor& processor, juce::MemoryBlock& destData);
+
+	//returns false and leaves the parameters alone if the data isn't a state this build can read
+	bool read(juce::AudioProcessor& processor, const void* data, int sizeInBytes);
+}
@@ -0,0 +1,148 @@
+/*
+  ==============================================================================
+
+    Factory presets with their coefficients designed ahead of time.
+
+  ==============================================================================
+*/
+
+#include "PresetBank.h"
+
+namespace
+{
+	struct FactoryPreset
+	{
+		const char* name;
+		float lowCutFreq;
+		Slope lowCutSlope;
+		float peakFreq, peakGainInDecibels, peakQuality;
+		float highCutFreq;
+		Slope highCutSlope;
+	};
+
+	//every value sits on its parameter's step, so the parameters reproduce the designed sets exactly
+	const FactoryPreset factoryPresets[] =
+	{
+		{ "Flat",			20.f,	Slope_12,	750.f,		0.f,	1.f,	20000.f,	Slope_12 },
+		{ "Rumble Filter",	80.f,	Slope_24,	750.f,		0.f,	1.f,	20000.f,	Slope_12 },
+		{ "Vocal Presence",	100.f,	Slope_24,	3000.f,		4.f,	0.8f,	16000.f,	Slope_12 },
+		{ "Mud Cut",		40.f,	Slope_12,	300.f,		-5.f,	1.4f,	20000.f,	Slope_12 },
+		{ "Air",			20.f,	Slope_12,	12000.f,	5.f,	0.5f,	20000.f,	Slope_12 },
+		{ "Warm",			20.f,	Slope_12,	150.f,		3.f,	0.7f,	8000.f,		Slope_12 },
+		{ "De-Harsh",		20.f,	Slope_12,	3500.f,		-4.f,	2.f,	20000.f,	Slope_12 },
+		{ "Telephone",		400.f,	Slope_48,	1500.f,		6.f,	1.2f,	3400.f,		Slope_48 }
+	};
+
+	constexpr int numFactoryPresets = static_cast<int>(sizeof(factoryPresets) / sizeof(factoryPresets[0]));
+
+	ChainSettings toChainSettings(const FactoryPreset& preset)
+	{
+		ChainSettings settings;
+
+		settings.lowCutFreq = preset.lowCutFreq;
+		settings.lowCutSlope = preset.lowCutSlope;
+		settings.bands[0] = { true, Band_Peak, preset.peakFreq, preset.peakGainInDecibels, preset.peakQuality }; //the other bands stay off
+		settings.highCutFreq = preset.highCutFreq;
+		settings.highCutSlope = preset.highCutSlope;
+
+		return settings;
+	}
+}
+
+PresetBank::PresetBank(ParameterSync parameterSync)
+	: syncParameters(std::move(parameterSync))
+{
+}
+
+PresetBank::~PresetBank()
+{
+	stopTimer();
+}
+
+void PresetBank::prepare(double sampleRate, bool syncWithAudioThread)
+{
+	if (syncWithAudioThread)
+		startTimer(syncIntervalMs);
+	else
+		stopTimer();
+
+	designs.resize(static_cast<size_t>(numFactoryPresets));
+
+	for (int factor = Oversampling_Off; factor <= Oversampling_4x; ++factor)
+		cutTables[static_cast<size_t>(factor)] = cutFilterTables->getTable(sampleRate * (1 << factor));
+
+	for (int i = 0; i < numFactoryPresets; ++i)
+	{
+		const auto settings = toChainSettings(factoryPresets[i]);
+
+		for (int factor = Oversampling_Off; factor <= Oversampling_4x; ++factor)
+		{
+			auto& chainCoefficients = designs[static_cast<size_t>(i)][static_cast<size_t>(factor)];
+			chainCoefficients.sampleRate = sampleRate * (1 << factor);
+
+			const auto& cutTable = *cutTables[static_cast<size_t>(factor)];
+			cutTable.makeLowCutCoefficients(chainCoefficients.lowCut, settings.lowCutFreq, settings.lowCutSlope);
+			cutTable.makeHighCutCoefficients(chainCoefficients.highCut, settings.highCutFreq, settings.highCutSlope);
+			chainCoefficients.lowCutSlope = settings.lowCutSlope;
+			chainCoefficients.highCutSlope = settings.highCutSlope;
+
+			for (int band = 0; band < maxBands; ++band)
+				designCache->makeBandCoefficients(chainCoefficients, settings, band);
+		}
+	}
+}
+
+void PresetBank::release()
+{
+	stopTimer();
+	timerCallback(); //a program change from the last block still gets its parameters
+}
+
+int PresetBank::getNumPresets() const noexcept
+{
+	return numFactoryPresets;
+}
+
+juce::String PresetBank::getPresetName(int index) const
+{
+	if (juce::isPositiveAndBelow(index, numFactoryPresets))
+		return factoryPresets[index].name;
+
+	return {};
+}
+
+ChainSettings PresetBank::getPresetSettings(int index) const
+{
+	if (juce::isPositiveAndBelow(index, numFactoryPresets))
+		return toChainSettings(factoryPresets[index]);
+
+	return {};
+}
+
+void PresetBank::select(int index) noexcept
+{
+	if (!juce::isPositiveAndBelow(index, numFactoryPresets))
+		return;
+
+	currentPreset = index;
+	pendingPreset = index;
+}
+
+const ChainCoefficients* PresetBank::pullSelected(Oversampling oversampling) noexcept
+{
+	const auto index = pendingPreset.exchange(-1);
+
+	if (index < 0 || designs.empty())
+		return nullptr;
+
+	presetToSync = index;
+	return &designs[static_cast<size_t>(index)][static_cast<size_t>(oversampling)];
+}
+
+void PresetBank::timerCallback()
+{
+	const auto index = presetToSync.exchange(-1);
+
+	if (index >= 0 && syncParameters != nullptr)
+		syncParameters(toChainSettings(factoryPresets[index]));
+}
@@ -0,0 +1,69 @@
+/*
+  ==============================================================================
+
+    Factory presets with their coefficients designed ahead of time. prepare()
+    designs every preset for every oversampling rate, so switching programs
+    on the audio thread, from a MIDI program change or from the host, only
+    hands out a pointer to a finished set.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "FilterCoefficients.h"
+#include "DesignCache.h"
+#include "CutFilterTables.h"
+
+class PresetBank : private juce::Timer
+{
+public:
+	//message thread, applies a selected preset to the parameters so the editor, the
+	//saved state and the designer all follow what the audio thread switched to
+	using ParameterSync = std::function<void(const ChainSettings&)>;
+
+	explicit PresetBank(ParameterSync parameterSync);
+	~PresetBank() override;
+
+	//designs the whole bank for a new host sample rate, call while the audio thread is stopped. The
+	//parameter sync only runs between prepare() and release(), and only when something can switch
+	//programs on the audio thread, an offline render sets its parameters up front
+	void prepare(double sampleRate, bool syncWithAudioThread);
+	void release();
+
+	int getNumPresets() const noexcept;
+	int getCurrentPreset() const noexcept { return currentPreset.load(); }
+	juce::String getPresetName(int index) const;
+	ChainSettings getPresetSettings(int index) const;
+
+	//any thread, switching happens at the start of the next block
+	void select(int index) noexcept;
+
+	//audio thread only, wait free. Returns the set of a newly selected preset for the
+	//given oversampling factor, or nullptr when nothing was selected since the last call
+	const ChainCoefficients* pullSelected(Oversampling oversampling) noexcept;
+
+private:
+	void timerCallback() override;
+
+	static constexpr int syncIntervalMs = 50;
+
+	ParameterSync syncParameters;
+
+	//every preset designed at the host rate and at both oversampled rates, written only in prepare()
+	std::vector<std::array<ChainCoefficients, 3>> designs;
+	juce::SharedResourcePointer<DesignCache> designCache;
+
+	//the cuts from the tables the designer reads, so a program change and the designer's next set for the
+	//same settings are the same coefficients and nothing jumps once the parameters have caught up
+	juce::SharedResourcePointer<CutFilterTables> cutFilterTables;
+	std::array<std::shared_ptr<const CutFilterTable>, 3> cutTables;	//held on to, the designer picks the same ones up
+
+	std::atomic<int> currentPreset{ 0 };
+	std::atomic<int> pendingPreset{ -1 };	//selected but not yet picked up by the audio thread
+	std::atomic<int> presetToSync{ -1 };	//picked up, parameters not yet updated
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(PresetBank)
+};
@@ -0,0 +1,266 @@
+/*
+  ==============================================================================
+
+    Opt-in checker for real-time safety.
+
+  ==============================================================================
+*/
+
+#include "RealtimeGuard.h"
+
+#if EQ_REALTIME_GUARD
+
+#if JUCE_LINUX
+ #include <dlfcn.h>
+ #include <execinfo.h>
+ #include <pthread.h>
+ #include <sys/syscall.h>
+ #include <unistd.h>
+#endif
+
+namespace
+{
+	constexpr int maxRecorded = 64;	//violations kept with a stack trace between two takeViolations()
+	constexpr int maxFrames = 32;
+
+	enum RecordState
+	{
+		recordFree,
+		recordWriting,
+		recordReady
+	};
+
+	//filled in place on the offending thread, nothing in here may allocate. A slot is claimed by moving
+	//it from free to writing and only handed back to the writers by takeViolations() once it was read,
+	//so a record is never read half written and never overwritten before it was read
+	struct Record
+	{
+		const char* what{ nullptr };
+		void* frames[maxFrames]{};
+		int numFrames{ 0 };
+		juce::int64 order{ 0 };		//which violation it was, the slots fill up in any order
+		std::atomic<int> state{ recordFree };
+	};
+
+	Record records[maxRecorded];
+	std::atomic<juce::int64> numViolations{ 0 };
+	std::atomic<bool> enabled{ false };
+
+	//initial exec, so reading these never calls into the dynamic loader, which might allocate
+   #if JUCE_LINUX
+	#define EQ_REALTIME_GUARD_TLS static thread_local __attribute__((tls_model("initial-exec")))
+   #else
+	#define EQ_REALTIME_GUARD_TLS static thread_local
+   #endif
+	EQ_REALTIME_GUARD_TLS int realtimeDepth = 0;
+	EQ_REALTIME_GUARD_TLS bool reporting = false; //backtrace() itself may allocate the first time round
+
+	void report(const char* what) noexcept
+	{
+		if (realtimeDepth == 0 || reporting || !enabled.load(std::memory_order_relaxed))
+			return;
+
+		reporting = true;
+		const auto order = numViolations.fetch_add(1, std::memory_order_relaxed);
+
+		//when every slot is taken the violation is only counted
+		for (auto& record : records)
+		{
+			auto expected = static_cast<int>(recordFree);
+
+			if (!record.state.compare_exchange_strong(expected, recordWriting, std::memory_order_acquire, std::memory_order_relaxed))
+				continue;
+
+			record.what = what;
+			record.order = order;
+
+		   #if JUCE_LINUX
+			record.numFrames = backtrace(record.frames, maxFrames);
+		   #endif
+
+			record.state.store(recordReady, std::memory_order_release);
+			break;
+		}
+
+		reporting = false;
+	}
+}
+
+RealtimeGuard::ScopedRealtimeSection::ScopedRealtimeSection() noexcept
+{
+	++realtimeDepth;
+}
+
+RealtimeGuard::ScopedRealtimeSection::~ScopedRealtimeSection() noexcept
+{
+	--realtimeDepth;
+}
+
+void RealtimeGuard::setEnabled(bool shouldBeEnabled) noexcept
+{
+   #if JUCE_LINUX
+	if (shouldBeEnabled)
+	{
+		//the first backtrace() loads the unwinder, get that out of the way on this thread
+		void* frames[2];
+		backtrace(frames, 2);
+	}
+   #endif
+
+	enabled = shouldBeEnabled;
+}
+
+bool RealtimeGuard::isEnabled() noexcept
+{
+	return enabled.load();
+}
+
+std::vector<RealtimeGuard::Violation> RealtimeGuard::takeViolations()
+{
+	std::vector<std::pair<juce::int64, Violation>> taken;
+
+	//records still being written are left for the next call
+	for (auto& record : records)
+	{
+		if (record.state.load(std::memory_order_acquire) != recordReady)
+			continue;
+
+		Violation violation{ record.what, {} };
+
+	   #if JUCE_LINUX
+		if (auto** symbols = backtrace_symbols(record.frames, record.numFrames))
+		{
+			for (int frame = 0; frame < record.numFrames; ++frame)
+				violation.stackTrace << "    " << symbols[frame] << juce::newLine;
+
+			::free(symbols);
+		}
+	   #endif
+
+		taken.emplace_back(record.order, std::move(violation));
+		record.state.store(recordFree, std::memory_order_release);
+	}
+
+	std::sort(taken.begin(), taken.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+
+	std::vector<Violation> violations;
+
+	for (auto& entry : taken)
+		violations.push_back(std::move(entry.second));
+
+	return violations;
+}
+
+juce::int64 RealtimeGuard::getNumViolations() noexcept
+{
+	return numViolations.load();
+}
+
+//==============================================================================
+#if JUCE_LINUX
+namespace
+{
+	using MutexLock = int (*)(pthread_mutex_t*);
+
+	//glibc has no public alias for this one, so the real function is looked up once
+	MutexLock getRealMutexLock() noexcept
+	{
+		static const auto realMutexLock = reinterpret_cast<MutexLock>(dlsym(RTLD_NEXT, "pthread_mutex_lock"));
+		return realMutexLock;
+	}
+
+	const auto mutexLockResolvedAtStartup = getRealMutexLock();
+}
+
+//definitions in the executable take precedence over glibc's, the real ones stay reachable
+//through their internal aliases, dlsym or straight through the system call
+extern "C"
+{
+	void* __libc_malloc(size_t);
+	void* __libc_calloc(size_t, size_t);
+	void* __libc_realloc(void*, size_t);
+	void* __libc_memalign(size_t, size_t);
+	void __libc_free(void*);
+
+	void* malloc(size_t size)
+	{
+		report("malloc");
+		return __libc_malloc(size);
+	}
+
+	void* calloc(size_t numElements, size_t size)
+	{
+		report("calloc");
+		return __libc_calloc(numElements, size);
+	}
+
+	void* realloc(void* p, size_t size)
+	{
+		report("realloc");
+		return __libc_realloc(p, size);
+	}
+
+	void* memalign(size_t alignment, size_t size)
+	{
+		report("memalign");
+		return __libc_memalign(alignment, size);
+	}
+
+	void* aligned_alloc(size_t alignment, size_t size)
+	{
+		report("aligned_alloc");
+		return __libc_memalign(alignment, size);
+	}
+
+	int posix_memalign(void** result, size_t alignment, size_t size)
+	{
+		report("posix_memalign");
+		*result = __libc_memalign(alignment, size);
+		return *result != nullptr ? 0 : ENOMEM;
+	}
+
+	void free(void* p)
+	{
+		if (p != nullptr)
+			report("free");
+
+		__libc_free(p);
+	}
+
+	int pthread_mutex_lock(pthread_mutex_t* mutex)
+	{
+		report("pthread_mutex_lock");
+		return getRealMutexLock()(mutex);
+	}
+
+	int nanosleep(const struct timespec* duration, struct timespec* remaining)
+	{
+		report("nanosleep");
+		return static_cast<int>(syscall(SYS_nanosleep, duration, remaining));
+	}
+
+	int usleep(useconds_t microseconds)
+	{
+		report("usleep");
+
+		struct timespec duration{ static_cast<time_t>(microseconds / 1000000), static_cast<long>(microseconds % 1000000) * 1000 };
+		return static_cast<int>(syscall(SYS_nanosleep, &duration, nullptr));
+	}
+
+	unsigned int sleep(unsigned int seconds)
+	{
+		report("sleep");
+
+		struct timespec duration{ static_cast<time_t>(seconds), 0 }, remaining{ 0, 0 };
+		return syscall(SYS_nanosleep, &duration, &remaining) == 0 ? 0u : static_cast<unsigned int>(remaining.tv_sec);
+	}
+
+	int sched_yield()
+	{
+		report("sched_yield");
+		return static_cast<int>(syscall(SYS_sched_yield));
+	}
+}
+#endif
+
+#endif
@@ -0,0 +1,83 @@
+/*
+  ==============================================================================
+
+    Opt-in checker for real-time safety. Build with EQ_REALTIME_GUARD=1 and
+    call RealtimeGuard::setEnabled(true), then every heap allocation, mutex
+    lock or sleeping call made on a thread inside a
+    ScopedRealtimeSection is recorded as a violation together with a stack
+    trace. processBlock opens such a section for its whole duration.
+
+    The calls are intercepted by defining malloc, free, pthread_mutex_lock,
+    nanosleep and friends in the binary, so it works on Linux and in
+    executables, which is what the headless harness is. Inside a host the
+    host's own definitions may win. Without EQ_REALTIME_GUARD everything
+    here compiles to nothing.
+
+    What is intercepted: malloc, calloc, realloc, the aligned allocators,
+    free, pthread_mutex_lock (and with it std::mutex and juce::CriticalSection),
+    nanosleep, usleep, sleep and sched_yield. Not caught are the other ways
+    to block: condition variable and semaphore waits, futex calls made
+    directly, file and socket I/O (read, write, open, poll and the like),
+    page faults on memory that isn't resident, and anything reaching the
+    kernel through raw syscall() or inline assembly. Spin locks that never
+    call into the kernel aren't seen either.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+#ifndef EQ_REALTIME_GUARD
+ #define EQ_REALTIME_GUARD 0
+#endif
+
+namespace RealtimeGuard
+{
+	struct Violation
+	{
+		const char* what;			//a string literal naming the intercepted call
+		juce::String stackTrace;
+	};
+
+   #if EQ_REALTIME_GUARD
+	//marks the calling thread as real-time for its lifetime, sections may nest
+	struct ScopedRealtimeSection
+	{
+		ScopedRealtimeSection() noexcept;
+		~ScopedRealtimeSection() noexcept;
+
+		JUCE_DECLARE_NON_COPYABLE(ScopedRealtimeSection)
+	};
+
+	//whether calls are actually intercepted in this build
+   #if JUCE_LINUX
+	constexpr bool isAvailable() noexcept { return true; }
+   #else
+	constexpr bool isAvailable() noexcept { return false; }
+   #endif
+
+	//any thread, off by default so a guarded build behaves normally until asked
+	void setEnabled(bool shouldBeEnabled) noexcept;
+	bool isEnabled() noexcept;
+
+	//everything since the last call, with the stack traces symbolised. Not for the audio thread
+	std::vector<Violation> takeViolations();
+
+	//how many violations happened, including ones that didn't fit into the record
+	juce::int64 getNumViolations() noexcept;
+   #else
+	struct ScopedRealtimeSection
+	{
+		ScopedRealtimeSection() noexcept {}
+		~ScopedRealtimeSection() noexcept {}
+	};
+
+	constexpr bool isAvailable() noexcept { return false; }
+	inline void setEnabled(bool) noexcept {}
+	inline bool isEnabled() noexcept { return false; }
+	inline std::vector<Violation> takeViolations() { return {}; }
+	inline juce::int64 getNumViolations() noexcept { return 0; }
+   #endif
+}
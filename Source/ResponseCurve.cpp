@@ -0,0 +1,142 @@
+/*
+  ==============================================================================
+
+    Frequency response of the whole chain, drawn over the analyzer.
+
+  ==============================================================================
+*/
+
+#include "ResponseCurve.h"
+#include "PluginProcessor.h"
+
+ResponseCurve::ResponseCurve(AudioPluginAudioProcessor& p) : audioProcessor(p)
+{
+	for (auto* param : audioProcessor.getParameters())
+		param->addListener(this);
+
+	setInterceptsMouseClicks(false, false);
+	setBufferedToImage(true); //paint() only runs after repaint() below, the analyzer underneath just composites the image
+
+	startTimerHz(30);
+}
+
+ResponseCurve::~ResponseCurve()
+{
+	for (auto* param : audioProcessor.getParameters())
+		param->removeListener(this);
+}
+
+void ResponseCurve::parameterValueChanged(int, float)
+{
+	parametersChanged = true; //can arrive on any thread, the timer picks it up
+}
+
+void ResponseCurve::timerCallback()
+{
+	const auto sampleRate = audioProcessor.getSampleRate();
+	const auto rateChanged = sampleRate != gridSampleRate;
+
+	if (!parametersChanged.exchange(false) && !rateChanged)
+		return;
+
+	const auto chainSettings = getChainSettings(audioProcessor.apvts);
+	const auto gridChanged = rateChanged || chainSettings.oversampling != gridOversampling;
+
+	if (!gridChanged
+		&& !lowCutChanged(chainSettings, lastSettings)
+		&& !highCutChanged(chainSettings, lastSettings)
+		&& !bandsChanged(chainSettings, lastSettings))
+		return;
+
+	if (gridChanged)
+		prepareGrid(sampleRate, chainSettings.oversampling);
+
+	updateCurve(chainSettings);
+	repaint();
+}
+
+void ResponseCurve::prepareGrid(double sampleRate, Oversampling oversampling)
+{
+	gridSampleRate = sampleRate;
+	gridOversampling = oversampling;
+
+	const auto width = juce::jmax(1, getWidth());
+
+	cosW.resize(static_cast<size_t>(width));
+	cos2W.resize(static_cast<size_t>(width));
+	magnitudes.resize(static_cast<size_t>(width));
+
+	if (sampleRate <= 0.0)
+		return;
+
+	for (int factor = Oversampling_Off; factor <= Oversampling_4x; ++factor)
+		cutTables[static_cast<size_t>(factor)] = cutFilterTables->getTable(sampleRate * (1 << factor));
+
+	//the coefficients are designed at the rate the chain runs at, so the grid has to be in that rate's
+	//radians or every point would read the response an octave up per oversampling step
+	const auto designRate = sampleRate * (1 << oversampling);
+
+	for (int x = 0; x < width; ++x)
+	{
+		const auto frequency = juce::mapToLog10(static_cast<double>(x) / width, 20.0, 20000.0);
+		const auto omega = juce::MathConstants<double>::twoPi * frequency / designRate;
+
+		cosW[static_cast<size_t>(x)] = std::cos(omega);
+		cos2W[static_cast<size_t>(x)] = std::cos(2.0 * omega);
+	}
+}
+
+void ResponseCurve::updateCurve(const ChainSettings& chainSettings)
+{
+	lastSettings = chainSettings;
+	curve.clear();
+
+	if (gridSampleRate <= 0.0 || magnitudes.empty())
+		return;
+
+	//same design the audio path runs, including the oversampled rate
+	jassert(chainSettings.oversampling == gridOversampling);
+
+	ChainCoefficients chainCoefficients;
+	chainCoefficients.sampleRate = gridSampleRate * (1 << chainSettings.oversampling);
+
+	const auto& cutTable = *cutTables[static_cast<size_t>(chainSettings.oversampling)];
+	cutTable.makeLowCutCoefficients(chainCoefficients.lowCut, chainSettings.lowCutFreq, chainSettings.lowCutSlope);
+	cutTable.makeHighCutCoefficients(chainCoefficients.highCut, chainSettings.highCutFreq, chainSettings.highCutSlope);
+	chainCoefficients.lowCutSlope = chainSettings.lowCutSlope;
+	chainCoefficients.highCutSlope = chainSettings.highCutSlope;
+
+	for (int band = 0; band < maxBands; ++band)
+		designCache->makeBandCoefficients(chainCoefficients, chainSettings, band);
+
+	const auto numPoints = static_cast<int>(magnitudes.size());
+	getMagnitudesForGrid(chainCoefficients, cosW.data(), cos2W.data(), magnitudes.data(), numPoints);
+
+	const auto bounds = getLocalBounds().toFloat();
+
+	for (int x = 0; x < numPoints; ++x)
+	{
+		const auto decibels = juce::jlimit(-maxDecibels, maxDecibels,
+			static_cast<float>(juce::Decibels::gainToDecibels(magnitudes[static_cast<size_t>(x)])));
+		const auto y = juce::jmap(decibels, -maxDecibels, maxDecibels, bounds.getBottom(), bounds.getY());
+
+		if (x == 0)
+			curve.startNewSubPath(bounds.getX(), y);
+		else
+			curve.lineTo(bounds.getX() + x, y);
+	}
+}
+
+void ResponseCurve::paint(juce::Graphics& g)
+{
+	g.setColour(juce::Colours::white);
+	g.strokePath(curve, juce::PathStrokeType(2.f));
+}
+
+void ResponseCurve::resized()
+{
+	const auto chainSettings = getChainSettings(audioProcessor.apvts);
+
+	prepareGrid(audioProcessor.getSampleRate(), chainSettings.oversampling);
+	updateCurve(chainSettings);
+}
@@ -0,0 +1,59 @@
+/*
+  ==============================================================================
+
+    Frequency response of the whole chain, drawn over the analyzer. The curve
+    is only recomputed when the settings or the size change; every other
+    repaint is served from the component's cached image.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "ChainSettings.h"
+#include "DesignCache.h"
+#include "CutFilterTables.h"
+
+class AudioPluginAudioProcessor;
+
+class ResponseCurve : public juce::Component,
+	private juce::AudioProcessorParameter::Listener,
+	private juce::Timer
+{
+public:
+	explicit ResponseCurve(AudioPluginAudioProcessor& p);
+	~ResponseCurve() override;
+
+	void paint(juce::Graphics& g) override;
+	void resized() override;
+
+private:
+	void parameterValueChanged(int parameterIndex, float newValue) override;
+	void parameterGestureChanged(int, bool) override {}
+	void timerCallback() override;
+
+	//one point per pixel column, log spaced from 20 Hz to 20 kHz, in radians at the oversampled rate
+	void prepareGrid(double sampleRate, Oversampling oversampling);
+	void updateCurve(const ChainSettings& chainSettings);
+
+	static constexpr float maxDecibels = 24.f; //same range as the peak gain
+
+	AudioPluginAudioProcessor& audioProcessor;
+
+	std::atomic<bool> parametersChanged{ true };
+	ChainSettings lastSettings;
+
+	double gridSampleRate{ 0.0 };
+	Oversampling gridOversampling{ Oversampling_Off };
+	std::vector<double> cosW, cos2W, magnitudes;
+	juce::SharedResourcePointer<DesignCache> designCache; //the audio path designed the same bands a moment ago
+
+	//the cuts come from the same tables the audio path reads, so the curve shows what is heard
+	juce::SharedResourcePointer<CutFilterTables> cutFilterTables;
+	std::array<std::shared_ptr<const CutFilterTable>, 3> cutTables;
+
+	juce::Path curve;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ResponseCurve)
+};
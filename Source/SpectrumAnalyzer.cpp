@@ -0,0 +1,138 @@
+/*
+  ==============================================================================
+
+    Pre/post spectrum display.
+
+  ==============================================================================
+*/
+
+#include "SpectrumAnalyzer.h"
+#include "PluginProcessor.h"
+
+SpectrumAnalyzer::Trace::Trace(AnalyzerFifo& f)
+	: fifo(f),
+	history(fftSize, 0.f),
+	incoming(AnalyzerFifo::capacity, 0.f),
+	fftData(fftSize * 2, 0.f),
+	levels(fftSize / 2 + 1, minDecibels)
+{
+}
+
+bool SpectrumAnalyzer::Trace::update(juce::dsp::FFT& fftEngine, const std::vector<float>& window)
+{
+	const auto numPulled = fifo.pull(incoming.data(), static_cast<int>(incoming.size()));
+
+	if (numPulled == 0)
+		return false;
+
+	//slide the newest samples into the history
+	if (numPulled >= fftSize)
+	{
+		std::copy(incoming.begin() + (numPulled - fftSize), incoming.begin() + numPulled, history.begin());
+	}
+	else
+	{
+		std::move(history.begin() + numPulled, history.end(), history.begin());
+		std::copy(incoming.begin(), incoming.begin() + numPulled, history.end() - numPulled);
+	}
+
+	std::fill(fftData.begin(), fftData.end(), 0.f);
+	juce::FloatVectorOperations::multiply(fftData.data(), history.data(), window.data(), fftSize);
+
+	fftEngine.performFrequencyOnlyForwardTransform(fftData.data());
+
+	//a full scale sine ends up at fftSize / 4 with the hann window
+	const auto scale = 4.f / static_cast<float>(fftSize);
+
+	for (size_t bin = 0; bin < levels.size(); ++bin)
+	{
+		const auto decibels = juce::Decibels::gainToDecibels(fftData[bin] * scale, minDecibels);
+		levels[bin] = juce::jmax(decibels, levels[bin] - decayPerFrame);
+	}
+
+	return true;
+}
+
+void SpectrumAnalyzer::Trace::rebuildPath(juce::Rectangle<float> bounds, double sampleRate)
+{
+	path.clear();
+
+	if (sampleRate <= 0.0)
+		return;
+
+	const auto binWidth = sampleRate / fftSize;
+	bool started = false;
+
+	for (size_t bin = 1; bin < levels.size(); ++bin)
+	{
+		const auto frequency = bin * binWidth;
+
+		if (frequency < 20.0 || frequency > 20000.0)
+			continue;
+
+		const auto x = bounds.getX() + bounds.getWidth() * static_cast<float>(juce::mapFromLog10(frequency, 20.0, 20000.0));
+		const auto y = juce::jmap(levels[bin], minDecibels, 0.f, bounds.getBottom(), bounds.getY());
+
+		if (!started)
+			path.startNewSubPath(x, y);
+		else
+			path.lineTo(x, y);
+
+		started = true;
+	}
+}
+
+//==============================================================================
+SpectrumAnalyzer::SpectrumAnalyzer(AudioPluginAudioProcessor& p)
+	: audioProcessor(p),
+	window(fftSize, 0.f),
+	preTrace(p.preAnalyzerFifo),
+	postTrace(p.postAnalyzerFifo)
+{
+	juce::dsp::WindowingFunction<float>::fillWindowingTables(window.data(), fftSize,
+		juce::dsp::WindowingFunction<float>::hann, false);
+
+	setInterceptsMouseClicks(false, false);
+
+	audioProcessor.analyzerActive = true; //processBlock only feeds the FIFOs while this is set
+	startTimerHz(frameRate);
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+	stopTimer();
+	audioProcessor.analyzerActive = false;
+}
+
+void SpectrumAnalyzer::timerCallback()
+{
+	const auto preChanged = preTrace.update(fft, window);
+	const auto postChanged = postTrace.update(fft, window);
+
+	if (!preChanged && !postChanged)
+		return;
+
+	const auto bounds = getLocalBounds().toFloat();
+
+	preTrace.rebuildPath(bounds, audioProcessor.getSampleRate());
+	postTrace.rebuildPath(bounds, audioProcessor.getSampleRate());
+
+	repaint();
+}
+
+void SpectrumAnalyzer::paint(juce::Graphics& g)
+{
+	using namespace juce;
+
+	g.setColour(Colour(120u, 120u, 130u).withAlpha(0.6f));
+	g.strokePath(preTrace.path, PathStrokeType(1.f));
+
+	g.setColour(Colour(255u, 154u, 1u));
+	g.strokePath(postTrace.path, PathStrokeType(1.5f));
+}
+
+void SpectrumAnalyzer::resized()
+{
+	preTrace.rebuildPath(getLocalBounds().toFloat(), audioProcessor.getSampleRate());
+	postTrace.rebuildPath(getLocalBounds().toFloat(), audioProcessor.getSampleRate());
+}
@@ -0,0 +1,57 @@
+/*
+  ==============================================================================
+
+    Pre/post spectrum display. All the FFT work happens here on the message
+    thread at a capped frame rate; the audio thread only feeds the FIFOs,
+    and only while an editor is open.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "AnalyzerFifo.h"
+
+class AudioPluginAudioProcessor;
+
+class SpectrumAnalyzer : public juce::Component, private juce::Timer
+{
+public:
+	explicit SpectrumAnalyzer(AudioPluginAudioProcessor& p);
+	~SpectrumAnalyzer() override;
+
+	void paint(juce::Graphics& g) override;
+	void resized() override;
+
+private:
+	void timerCallback() override;
+
+	static constexpr int fftOrder = 11;
+	static constexpr int fftSize = 1 << fftOrder;
+	static constexpr int frameRate = 30;
+	static constexpr float minDecibels = -72.f;
+	static constexpr float decayPerFrame = 1.5f; //dB the display falls per frame, so peaks linger a little
+
+	struct Trace
+	{
+		explicit Trace(AnalyzerFifo& f);
+
+		//pulls whatever arrived since the last frame, returns false if nothing did
+		bool update(juce::dsp::FFT& fft, const std::vector<float>& window);
+		void rebuildPath(juce::Rectangle<float> bounds, double sampleRate);
+
+		AnalyzerFifo& fifo;
+		std::vector<float> history, incoming, fftData, levels;
+		juce::Path path;
+	};
+
+	AudioPluginAudioProcessor& audioProcessor;
+
+	juce::dsp::FFT fft{ fftOrder };
+	std::vector<float> window;
+
+	Trace preTrace, postTrace;
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(SpectrumAnalyzer)
+};
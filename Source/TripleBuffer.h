@@ -0,0 +1,55 @@
+/*
+  ==============================================================================
+
+    Wait-free handoff of the latest value from one producer thread to one
+    consumer thread. Three slots are allocated up front, the producer always
+    owns one, the consumer owns one and the third is swapped between them
+    with a single atomic exchange, so neither side ever waits or allocates.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+template <typename ValueType>
+class TripleBuffer
+{
+public:
+	TripleBuffer() = default;
+
+	//==============================================================================
+	//producer side: fill the write slot, then publish it
+	ValueType& getWriteSlot() noexcept { return slots[writeIndex]; }
+
+	void publish() noexcept
+	{
+		//hand the freshly written slot over and take whatever was in the middle back,
+		//that slot was either never read or already retired by the consumer
+		writeIndex = middle.exchange(writeIndex | newDataFlag, std::memory_order_acq_rel) & indexMask;
+	}
+
+	//==============================================================================
+	//consumer side: returns true if a new value was swapped into the read slot
+	bool pull() noexcept
+	{
+		if ((middle.load(std::memory_order_acquire) & newDataFlag) == 0)
+			return false;
+
+		readIndex = middle.exchange(readIndex, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+
+	const ValueType& getReadSlot() const noexcept { return slots[readIndex]; }
+
+private:
+	static constexpr int indexMask = 3;
+	static constexpr int newDataFlag = 4;
+
+	std::array<ValueType, 3> slots;
+	int writeIndex{ 0 }, readIndex{ 1 };
+	std::atomic<int> middle{ 2 };
+
+	JUCE_DECLARE_NON_COPYABLE(TripleBuffer)
+};
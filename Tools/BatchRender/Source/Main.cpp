@@ -0,0 +1,367 @@
+/*
+  ==============================================================================
+
+    Offline batch renderer for AudioPluginAudioProcessor. Every file gets
+    its own processor, configured from a saved state, a factory preset and
+    single parameter values, and the files are rendered in parallel on a
+    work stealing pool, see WorkStealingPool.h. Long files are split up by
+    channel when the settings keep the channels apart, see RenderJob.h.
+
+    BatchRender --input folder|file [--list paths.txt] --output folder
+                [--state state.bin] [--preset 3] [--set "Peak Gain=3;LowCut Freq=80"]
+                [--threads 64] [--block-size 1024] [--bits 16|24|32|float]
+                [--format wav|flac] [--tail] [--split-above 60] [--no-split]
+                [--report results.json]
+
+    BatchRender --list-presets
+    BatchRender [--state ...] [--preset ...] [--set ...] --save-state state.bin
+
+    Folders are searched recursively for .wav and .flac files and the
+    output keeps their layout below the output folder. Every output has
+    the input's length, sample rate, channels and bit depth unless told
+    otherwise, and is moved back by the processor's latency so it lines up
+    with the input. --tail appends the filters' decay.
+
+    A JSON report with every file and the overall throughput goes to
+    --report, or to stdout. The exit code is 1 if any file failed.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginState.h"
+#include "RenderJob.h"
+#include "WorkStealingPool.h"
+#include <set>
+
+namespace
+{
+	struct Job
+	{
+		juce::File input, output;
+		juce::int64 size;
+	};
+
+	struct Options
+	{
+		juce::Array<juce::File> inputs, folders;	//folders[i] is what inputs[i] was found in, or no file
+		juce::File outputFolder, report, stateOutput;
+		juce::String format;						//empty keeps the input's
+		int numThreads{ 0 };
+		bool split{ true };
+		bool listPresets{ false };
+		RenderJob::Settings settings;
+	};
+
+	bool isAudioFile(const juce::File& file)
+	{
+		return file.hasFileExtension("wav;flac");
+	}
+
+	void addInput(Options& options, const juce::File& path)
+	{
+		if (!path.isDirectory())
+		{
+			options.inputs.add(path);
+			options.folders.add({});
+			return;
+		}
+
+		for (const auto& entry : juce::RangedDirectoryIterator(path, true, "*", juce::File::findFiles))
+		{
+			if (isAudioFile(entry.getFile()))
+			{
+				options.inputs.add(entry.getFile());
+				options.folders.add(path);
+			}
+		}
+	}
+
+	juce::String parseOptions(const juce::ArgumentList& args, Options& options)
+	{
+		auto& settings = options.settings;
+
+		if (args.containsOption("--input"))
+			addInput(options, args.getFileForOption("--input"));
+
+		if (args.containsOption("--list"))
+		{
+			const auto list = args.getFileForOption("--list");
+
+			if (!list.existsAsFile())
+				return "Can't read " + list.getFullPathName();
+
+			juce::StringArray lines;
+			list.readLines(lines);
+
+			for (auto& line : lines)
+				if (line.trim().isNotEmpty())
+					addInput(options, juce::File::getCurrentWorkingDirectory().getChildFile(line.trim()));
+		}
+
+		if (args.containsOption("--output"))
+			options.outputFolder = args.getFileForOption("--output");
+
+		if (args.containsOption("--report"))
+			options.report = args.getFileForOption("--report");
+
+		if (args.containsOption("--save-state"))
+			options.stateOutput = args.getFileForOption("--save-state");
+
+		if (args.containsOption("--state"))
+		{
+			const auto state = args.getFileForOption("--state");
+
+			if (!state.loadFileAsData(settings.state))
+				return "Can't read " + state.getFullPathName();
+		}
+
+		if (args.containsOption("--preset"))
+			settings.preset = args.getValueForOption("--preset").getIntValue();
+
+		//"ID=value;ID=value", the IDs have spaces in them
+		if (args.containsOption("--set"))
+		{
+			for (auto& assignment : juce::StringArray::fromTokens(args.getValueForOption("--set"), ";", "\""))
+			{
+				if (!assignment.contains("="))
+					return "--set expects ID=value, not \"" + assignment + "\"";
+
+				settings.parameters.set(assignment.upToFirstOccurrenceOf("=", false, false).trim(),
+					assignment.fromFirstOccurrenceOf("=", false, false).trim());
+			}
+		}
+
+		if (args.containsOption("--threads"))
+			options.numThreads = juce::jmax(1, args.getValueForOption("--threads").getIntValue());
+
+		if (args.containsOption("--block-size"))
+			settings.blockSize = juce::jlimit(16, 65536, args.getValueForOption("--block-size").getIntValue());
+
+		if (args.containsOption("--bits"))
+		{
+			const auto bits = args.getValueForOption("--bits");
+			settings.floatingPoint = bits == "float";
+			settings.bitDepth = settings.floatingPoint ? 32 : bits.getIntValue();
+
+			if (settings.bitDepth != 16 && settings.bitDepth != 24 && settings.bitDepth != 32)
+				return "--bits takes 16, 24, 32 or float";
+		}
+
+		if (args.containsOption("--format"))
+		{
+			options.format = args.getValueForOption("--format").toLowerCase();
+
+			if (options.format != "wav" && options.format != "flac")
+				return "--format takes wav or flac";
+		}
+
+		if (settings.floatingPoint && options.format == "flac")
+			return "FLAC has no floating point samples";
+
+		if (args.containsOption("--split-above"))
+			settings.splitAboveSeconds = juce::jmax(0.0, args.getValueForOption("--split-above").getDoubleValue());
+
+		settings.includeTail = args.containsOption("--tail");
+		options.split = !args.containsOption("--no-split");
+		options.listPresets = args.containsOption("--list-presets");
+
+		return {};
+	}
+
+	//every output below the output folder, keeping the layout of the folders searched
+	juce::String planJobs(const Options& options, std::vector<Job>& jobs)
+	{
+		std::set<juce::String> outputs;
+
+		for (int i = 0; i < options.inputs.size(); ++i)
+		{
+			const auto& input = options.inputs.getReference(i);
+			const auto& folder = options.folders.getReference(i);
+
+			if (!input.existsAsFile())
+				return "Can't find " + input.getFullPathName();
+
+			auto output = options.outputFolder.getChildFile(folder != juce::File() ? input.getRelativePathFrom(folder) : input.getFileName());
+
+			if (options.format.isNotEmpty())
+				output = output.withFileExtension(options.format);
+
+			if (output == input)
+				return "Rendering " + input.getFullPathName() + " would overwrite it";
+
+			if (!outputs.insert(output.getFullPathName()).second)
+				return "More than one input would be rendered to " + output.getFullPathName();
+
+			jobs.push_back({ input, output, input.getSize() });
+		}
+
+		//dealt out in this order, so each queue has its longest files at the back, where its worker starts.
+		//The short ones sit at the front, where workers that run out early steal them to fill the gaps
+		std::sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return a.size < b.size; });
+		return {};
+	}
+
+	juce::var toVar(const RenderJob::Result& result)
+	{
+		auto* entry = new juce::DynamicObject();
+		entry->setProperty("input", result.input.getFullPathName());
+		entry->setProperty("output", result.output.getFullPathName());
+		entry->setProperty("succeeded", result.succeeded);
+
+		if (!result.succeeded)
+			entry->setProperty("error", result.error);
+
+		entry->setProperty("channels", result.numChannels);
+		entry->setProperty("sampleRate", result.sampleRate);
+		entry->setProperty("frames", result.numFrames);
+		entry->setProperty("splitByChannel", result.split);
+		entry->setProperty("renderSeconds", result.renderSeconds);
+
+		const auto audioSeconds = result.sampleRate > 0.0 ? static_cast<double>(result.numFrames) / result.sampleRate : 0.0;
+		entry->setProperty("realtimeFactor", result.renderSeconds > 0.0 ? audioSeconds / result.renderSeconds : 0.0);
+
+		return juce::var(entry);
+	}
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser; //the processors own timers, they need a message manager to exist
+
+	const juce::ArgumentList args(argc, argv);
+
+	Options options;
+
+	if (auto error = parseOptions(args, options); error.isNotEmpty())
+	{
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	//one processor up front checks the configuration once instead of failing every file with it
+	{
+		AudioPluginAudioProcessor probe;
+
+		if (options.listPresets)
+		{
+			for (int i = 0; i < probe.getNumPrograms(); ++i)
+				std::cout << i << ": " << probe.getProgramName(i) << std::endl;
+
+			return 0;
+		}
+
+		if (auto error = RenderJob::configure(probe, options.settings); error.isNotEmpty())
+		{
+			std::cerr << error << std::endl;
+			return 1;
+		}
+
+		options.settings.splitChannels = options.split && RenderJob::hasIndependentChannels(probe);
+
+		if (options.stateOutput != juce::File())
+		{
+			juce::MemoryBlock state;
+			probe.getStateInformation(state);
+
+			if (!options.stateOutput.replaceWithData(state.getData(), state.getSize()))
+			{
+				std::cerr << "Can't write " << options.stateOutput.getFullPathName() << std::endl;
+				return 1;
+			}
+
+			if (options.inputs.isEmpty())
+				return 0;
+		}
+	}
+
+	if (options.inputs.isEmpty() || options.outputFolder == juce::File())
+	{
+		std::cerr << "Usage: BatchRender --input folder|file [--list paths.txt] --output folder [options], see Main.cpp" << std::endl;
+		return 1;
+	}
+
+	std::vector<Job> jobs;
+
+	if (auto error = planJobs(options, jobs); error.isNotEmpty())
+	{
+		std::cerr << error << std::endl;
+		return 1;
+	}
+
+	juce::CriticalSection resultsLock;
+	juce::Array<juce::var> results;
+	int numFailed = 0;
+	double audioSeconds = 0.0;
+
+	const auto start = juce::Time::getMillisecondCounterHiRes();
+	juce::int64 numSteals = 0;
+	int numThreads = 0;
+
+	{
+		WorkStealingPool pool(options.numThreads);
+		numThreads = pool.getNumWorkers();
+
+		for (auto& job : jobs)
+		{
+			RenderJob::submit(pool, job.input, job.output, options.settings, [&](const RenderJob::Result& result)
+			{
+				const juce::ScopedLock sl(resultsLock);
+				results.add(toVar(result));
+
+				if (result.succeeded)
+					audioSeconds += static_cast<double>(result.numFrames) / result.sampleRate;
+				else
+					++numFailed;
+
+				std::cerr << (result.succeeded ? "." : "x") << std::flush;
+			});
+		}
+
+		pool.waitUntilDone();
+		numSteals = pool.getNumSteals();
+	}
+
+	std::cerr << std::endl;
+
+	const auto wallSeconds = (juce::Time::getMillisecondCounterHiRes() - start) * 0.001;
+
+	auto* report = new juce::DynamicObject();
+	report->setProperty("plugin", JucePlugin_Name);
+	report->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+	report->setProperty("cpu", juce::SystemStats::getCpuModel());
+	report->setProperty("threads", numThreads);
+	report->setProperty("files", static_cast<int>(jobs.size()));
+	report->setProperty("failed", numFailed);
+	report->setProperty("splitByChannel", options.settings.splitChannels);
+	report->setProperty("steals", numSteals);
+	report->setProperty("audioSeconds", audioSeconds);
+	report->setProperty("wallSeconds", wallSeconds);
+	report->setProperty("realtimeFactor", wallSeconds > 0.0 ? audioSeconds / wallSeconds : 0.0);
+	report->setProperty("results", results);
+
+	const auto json = juce::JSON::toString(juce::var(report));
+
+	if (options.report != juce::File())
+	{
+		if (!options.report.replaceWithText(json))
+		{
+			std::cerr << "Can't write " << options.report.getFullPathName() << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		std::cout << json << std::endl;
+	}
+
+	if (numFailed > 0)
+	{
+		std::cerr << numFailed << " of " << jobs.size() << " files failed" << std::endl;
+		return 1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    WAV output written through a memory mapped file.
+
+  ==============================================================================
+*/
+
+#include "MappedWavWriter.h"
+
+bool MappedWavWriter::canWrite(int numChannels, juce::int64 numFrames, SampleFormat format) noexcept
+{
+	const auto dataSize = numFrames * numChannels * getBytesPerSample(format);
+	return numChannels > 0 && dataSize + headerSize - 8 <= static_cast<juce::int64>(0xffffffffu);
+}
+
+int MappedWavWriter::getBytesPerSample(SampleFormat format) noexcept
+{
+	switch (format)
+	{
+		case SampleFormat::int16: return 2;
+		case SampleFormat::int24: return 3;
+		case SampleFormat::int32:
+		case SampleFormat::float32: return 4;
+	}
+
+	return 4;
+}
+
+MappedWavWriter::MappedWavWriter(const juce::File& outputFile, int channels, double sampleRate, juce::int64 frames, SampleFormat sampleFormat)
+	: file(outputFile), numChannels(channels), numFrames(frames), format(sampleFormat),
+	  frameSize(channels * getBytesPerSample(sampleFormat))
+{
+	jassert(canWrite(channels, frames, sampleFormat));
+
+	const auto bytesPerSample = getBytesPerSample(format);
+	const auto dataSize = static_cast<juce::uint32>(numFrames * frameSize);
+
+	//WAVE_FORMAT_EXTENSIBLE, which every reader understands and which is required above two channels or 16 bits
+	juce::MemoryOutputStream header;
+	header.write("RIFF", 4);
+	header.writeInt(static_cast<int>(dataSize + headerSize - 8));
+	header.write("WAVE", 4);
+
+	header.write("fmt ", 4);
+	header.writeInt(40);
+	header.writeShort(static_cast<short>(0xfffe));
+	header.writeShort(static_cast<short>(numChannels));
+	header.writeInt(static_cast<int>(sampleRate));
+	header.writeInt(static_cast<int>(sampleRate) * frameSize);
+	header.writeShort(static_cast<short>(frameSize));
+	header.writeShort(static_cast<short>(bytesPerSample * 8));
+	header.writeShort(22);
+	header.writeShort(static_cast<short>(bytesPerSample * 8));	//valid bits
+	header.writeInt(0);											//no speaker positions
+
+	//the sub format GUID, KSDATAFORMAT_SUBTYPE_PCM or _IEEE_FLOAT
+	header.writeShort(format == SampleFormat::float32 ? 3 : 1);
+	const juce::uint8 guid[] = { 0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xaa, 0x00, 0x38, 0x9b, 0x71 };
+	header.write(guid, sizeof(guid));
+
+	header.write("data", 4);
+	header.writeInt(static_cast<int>(dataSize));
+
+	jassert(static_cast<int>(header.getDataSize()) == headerSize);
+
+	{
+		file.deleteFile();
+		juce::FileOutputStream stream(file);
+
+		if (stream.failedToOpen() || !stream.write(header.getData(), header.getDataSize()))
+			return;
+
+		//the rest of the file is reserved by writing its last byte, the mapping fills in the middle
+		if (dataSize > 0 && !(stream.setPosition(headerSize + static_cast<juce::int64>(dataSize) - 1) && stream.writeByte(0)))
+			return;
+
+		stream.flush();
+
+		if (stream.getStatus().failed())
+			return;
+	}
+
+	mapping = std::make_unique<juce::MemoryMappedFile>(file, juce::MemoryMappedFile::readWrite, false);
+
+	if (mapping->getData() == nullptr || static_cast<juce::int64>(mapping->getSize()) < headerSize + static_cast<juce::int64>(dataSize))
+	{
+		mapping.reset();
+		return;
+	}
+
+	data = static_cast<char*>(mapping->getData()) + headerSize;
+}
+
+template <typename DestType>
+void MappedWavWriter::convert(int channel, juce::int64 startFrame, const float* samples, int numSamples) noexcept
+{
+	using namespace juce;
+	using Source = AudioData::Pointer<AudioData::Float32, AudioData::NativeEndian, AudioData::NonInterleaved, AudioData::Const>;
+	using Dest = AudioData::Pointer<DestType, AudioData::LittleEndian, AudioData::Interleaved, AudioData::NonConst>;
+
+	//the destination is interleaved over all of the file's channels, this only touches the one
+	Dest dest(data + startFrame * frameSize + channel * (frameSize / numChannels), numChannels);
+	dest.convertSamples(Source(samples), numSamples);
+}
+
+void MappedWavWriter::writeChannel(int channel, juce::int64 startFrame, const float* samples, int numSamples) noexcept
+{
+	jassert(isOpen() && juce::isPositiveAndBelow(channel, numChannels));
+	jassert(startFrame >= 0 && startFrame + numSamples <= numFrames);
+
+	if (data == nullptr)
+		return;
+
+	switch (format)
+	{
+		case SampleFormat::int16: convert<juce::AudioData::Int16>(channel, startFrame, samples, numSamples); break;
+		case SampleFormat::int24: convert<juce::AudioData::Int24>(channel, startFrame, samples, numSamples); break;
+		case SampleFormat::int32: convert<juce::AudioData::Int32>(channel, startFrame, samples, numSamples); break;
+		case SampleFormat::float32: convert<juce::AudioData::Float32>(channel, startFrame, samples, numSamples); break;
+	}
+}
+
+bool MappedWavWriter::finish()
+{
+	if (mapping == nullptr)
+		return false;
+
+	//unmapping writes the pages back, the data is on disk once the mapping is gone
+	data = nullptr;
+	mapping.reset();
+	return file.getSize() == headerSize + numFrames * frameSize;
+}
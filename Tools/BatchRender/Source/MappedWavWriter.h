@@ -0,0 +1,65 @@
+/*
+  ==============================================================================
+
+    WAV output written through a memory mapped file. The whole file is laid
+    out up front, header and all, so every channel of it can be written by a
+    different thread at any position without any locking: channel c of frame
+    i has a fixed place in the mapping. That is what lets the renderer split
+    a long file by channel.
+
+    Plain RIFF only, so the data has to stay below 4 GB. Bigger files and the
+    other formats go through a streaming juce::AudioFormatWriter instead.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+class MappedWavWriter
+{
+public:
+	//16, 24 or 32 bit integer, or 32 bit float
+	enum class SampleFormat
+	{
+		int16,
+		int24,
+		int32,
+		float32
+	};
+
+	//false when the data wouldn't fit into a RIFF file
+	static bool canWrite(int numChannels, juce::int64 numFrames, SampleFormat format) noexcept;
+
+	//creates the file at its final size and maps it. Check isOpen() afterwards
+	MappedWavWriter(const juce::File& file, int numChannels, double sampleRate, juce::int64 numFrames, SampleFormat format);
+
+	bool isOpen() const noexcept { return data != nullptr; }
+
+	//any thread, as long as no two threads write the same channel. Converts numFrames float
+	//samples into the file's format, clipping what doesn't fit, starting at startFrame
+	void writeChannel(int channel, juce::int64 startFrame, const float* samples, int numFrames) noexcept;
+
+	//flushes the mapping to disk
+	bool finish();
+
+private:
+	static int getBytesPerSample(SampleFormat format) noexcept;
+
+	template <typename DestType>
+	void convert(int channel, juce::int64 startFrame, const float* samples, int numFrames) noexcept;
+
+	juce::File file;
+	int numChannels;
+	juce::int64 numFrames;
+	SampleFormat format;
+	int frameSize;
+
+	std::unique_ptr<juce::MemoryMappedFile> mapping;
+	char* data{ nullptr };		//the first sample of the data chunk
+
+	static constexpr int headerSize = 12 + 8 + 40 + 8;	//RIFF, extensible fmt chunk, data chunk header
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MappedWavWriter)
+};
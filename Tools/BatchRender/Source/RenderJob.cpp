@@ -0,0 +1,403 @@
+/*
+  ==============================================================================
+
+    Renders one file through its own AudioPluginAudioProcessor.
+
+  ==============================================================================
+*/
+
+#include "RenderJob.h"
+#include "MappedWavWriter.h"
+#include "../../../Source/PluginProcessor.h"
+#include "../../../Source/PluginState.h"
+
+namespace RenderJob
+{
+	namespace
+	{
+		using Clock = std::chrono::steady_clock;
+
+		std::unique_ptr<juce::AudioFormatReader> createReader(const juce::File& file)
+		{
+			//WAV straight from the page cache, everything else streamed in blocks
+			if (file.hasFileExtension("wav"))
+			{
+				juce::WavAudioFormat wav;
+				std::unique_ptr<juce::MemoryMappedAudioFormatReader> mapped(wav.createMemoryMappedReader(file));
+
+				if (mapped != nullptr && mapped->mapEntireFile())
+					return mapped;
+			}
+
+			juce::AudioFormatManager formats;
+			formats.registerBasicFormats();
+			return std::unique_ptr<juce::AudioFormatReader>(formats.createReaderFor(file));
+		}
+
+		MappedWavWriter::SampleFormat getSampleFormat(const Settings& settings, const juce::AudioFormatReader& reader)
+		{
+			if (settings.floatingPoint || (settings.bitDepth == 0 && reader.usesFloatingPointData))
+				return MappedWavWriter::SampleFormat::float32;
+
+			switch (settings.bitDepth != 0 ? settings.bitDepth : static_cast<int>(reader.bitsPerSample))
+			{
+				case 24: return MappedWavWriter::SampleFormat::int24;
+				case 32: return MappedWavWriter::SampleFormat::int32;
+				default: return MappedWavWriter::SampleFormat::int16;
+			}
+		}
+
+		//the output of one file, either mapped and open to every channel at once, or streamed
+		//by a juce::AudioFormatWriter in one go from the start to the end
+		class Output
+		{
+		public:
+			juce::String open(const juce::File& file, const Settings& settings, const juce::AudioFormatReader& reader, juce::int64 numFrames)
+			{
+				const auto numChannels = static_cast<int>(reader.numChannels);
+				const auto format = getSampleFormat(settings, reader);
+
+				if (!file.getParentDirectory().createDirectory())
+					return "Can't create " + file.getParentDirectory().getFullPathName();
+
+				if (file.hasFileExtension("wav") && MappedWavWriter::canWrite(numChannels, numFrames, format))
+				{
+					mapped = std::make_unique<MappedWavWriter>(file, numChannels, reader.sampleRate, numFrames, format);
+					return mapped->isOpen() ? juce::String() : "Can't map " + file.getFullPathName();
+				}
+
+				//FLAC stops at 24 bits, and WAV data past 4 GB needs the RF64 header JUCE's writer knows about
+				const auto flac = file.hasFileExtension("flac");
+				const auto bits = format == MappedWavWriter::SampleFormat::int16 ? 16
+					: (format == MappedWavWriter::SampleFormat::int24 || flac ? 24 : 32);
+
+				std::unique_ptr<juce::AudioFormat> audioFormat;
+
+				if (flac)
+					audioFormat = std::make_unique<juce::FlacAudioFormat>();
+				else
+					audioFormat = std::make_unique<juce::WavAudioFormat>();
+
+				file.deleteFile();
+				auto stream = std::make_unique<juce::FileOutputStream>(file);
+
+				if (stream->failedToOpen())
+					return "Can't write " + file.getFullPathName();
+
+				streamed.reset(audioFormat->createWriterFor(stream.get(), reader.sampleRate, static_cast<unsigned int>(numChannels), bits, {}, 0));
+
+				if (streamed == nullptr)
+					return "Can't write " + juce::String(bits) + " bit " + audioFormat->getFormatName() + " to " + file.getFullPathName();
+
+				stream.release(); //the writer owns it now
+				return {};
+			}
+
+			bool isMapped() const noexcept { return mapped != nullptr; }
+
+			//numChannels channels starting at firstChannel. A streamed output only takes all channels, in order
+			bool write(const float* const* channels, int firstChannel, int numChannels, juce::int64 startFrame, int numFrames)
+			{
+				if (mapped != nullptr)
+				{
+					for (int ch = 0; ch < numChannels; ++ch)
+						mapped->writeChannel(firstChannel + ch, startFrame, channels[ch], numFrames);
+
+					return true;
+				}
+
+				jassert(firstChannel == 0 && streamed != nullptr);
+				return streamed->writeFromFloatArrays(channels, numChannels, numFrames);
+			}
+
+			bool finish()
+			{
+				if (mapped != nullptr)
+					return mapped->finish();
+
+				streamed.reset(); //flushes and writes the final header
+				return true;
+			}
+
+		private:
+			std::unique_ptr<MappedWavWriter> mapped;
+			std::unique_ptr<juce::AudioFormatWriter> streamed;
+		};
+
+		//what every task of a split file shares, the last one to finish reports the result
+		struct FileState
+		{
+			Result result;
+			Output output;
+			Clock::time_point start;
+
+			std::atomic<int> remaining{ 0 };
+			juce::SpinLock errorLock;
+			std::function<void(const Result&)> onFinished;
+
+			void fail(const juce::String& error)
+			{
+				const juce::SpinLock::ScopedLockType sl(errorLock);
+
+				if (result.error.isEmpty())
+					result.error = error;
+			}
+
+			void taskFinished()
+			{
+				if (--remaining > 0)
+					return;
+
+				if (result.error.isEmpty() && !output.finish())
+					result.error = "Can't finish " + result.output.getFullPathName();
+
+				result.succeeded = result.error.isEmpty();
+				result.renderSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+				if (!result.succeeded)
+					result.output.deleteFile();
+
+				onFinished(result);
+			}
+		};
+
+		//a processor set up for a range of the reader's channels
+		class ChannelRender
+		{
+		public:
+			ChannelRender(const Settings& renderSettings, int first, int num)
+				: settings(renderSettings), firstChannel(first), numChannels(num)
+			{
+			}
+
+			juce::String prepare(double sampleRate)
+			{
+				if (auto error = configure(processor, settings); error.isNotEmpty())
+					return error;
+
+				//offline the processor builds its linear phase kernel on this thread and has it in
+				//before prepareToPlay returns, so every worker builds its own at the same time
+				processor.setNonRealtime(true);
+				processor.setPlayConfigDetails(numChannels, numChannels, sampleRate, settings.blockSize);
+				processor.prepareToPlay(sampleRate, settings.blockSize);
+
+				buffer.setSize(numChannels, settings.blockSize);
+				rate = sampleRate;
+
+				if (processor.isLinearPhasePending())
+					return "The linear phase kernel didn't load";
+
+				return {};
+			}
+
+			//the filters' decay at the end of the input, in samples
+			juce::int64 getTailFrames() const
+			{
+				return static_cast<juce::int64>(std::ceil(processor.getTailLengthSeconds() * rate));
+			}
+
+			//runs the reader's channels through the processor, moved back by the processor's latency, so
+			//the output lines up with the input sample for sample. Input past the end of the file is silence
+			bool render(juce::AudioFormatReader& reader, Output& output, juce::int64 numFrames)
+			{
+				const auto latency = static_cast<juce::int64>(processor.getLatencySamples());
+				const auto blockSize = settings.blockSize;
+
+				std::vector<int*> sources(static_cast<size_t>(reader.numChannels), nullptr);
+				std::vector<const float*> blockChannels(static_cast<size_t>(numChannels));
+
+				for (juce::int64 position = 0, written = 0; written < numFrames; position += blockSize)
+				{
+					for (int ch = 0; ch < numChannels; ++ch)
+						sources[static_cast<size_t>(firstChannel + ch)] = reinterpret_cast<int*>(buffer.getWritePointer(ch));
+
+					if (!reader.read(sources.data(), static_cast<int>(sources.size()), position, blockSize, true))
+						return false;
+
+					if (!reader.usesFloatingPointData)
+						for (int ch = 0; ch < numChannels; ++ch)
+							juce::FloatVectorOperations::convertFixedToFloat(buffer.getWritePointer(ch),
+								reinterpret_cast<const int*>(buffer.getReadPointer(ch)), 1.f / static_cast<float>(0x7fffffff), blockSize);
+
+					processor.processBlock(buffer, midi);
+
+					//the first latency samples are what the processor put out before the input reached it
+					const auto first = static_cast<int>(juce::jlimit<juce::int64>(0, blockSize, latency - position));
+					const auto count = static_cast<int>(juce::jmin<juce::int64>(blockSize - first, numFrames - written));
+
+					if (count <= 0)
+						continue;
+
+					for (int ch = 0; ch < numChannels; ++ch)
+						blockChannels[static_cast<size_t>(ch)] = buffer.getReadPointer(ch, first);
+
+					if (!output.write(blockChannels.data(), firstChannel, numChannels, written, count))
+						return false;
+
+					written += count;
+				}
+
+				return true;
+			}
+
+			void release()
+			{
+				processor.releaseResources();
+			}
+
+		private:
+			const Settings& settings;
+			const int firstChannel, numChannels;
+			double rate{ 0.0 };
+
+			AudioPluginAudioProcessor processor;
+			juce::AudioBuffer<float> buffer;
+			juce::MidiBuffer midi;
+		};
+
+		void renderChannels(std::shared_ptr<FileState> state, const Settings& settings, int firstChannel, int numChannels)
+		{
+			auto reader = createReader(state->result.input);
+
+			if (reader == nullptr)
+			{
+				state->fail("Can't read " + state->result.input.getFullPathName());
+				state->taskFinished();
+				return;
+			}
+
+			ChannelRender render(settings, firstChannel, numChannels);
+
+			if (auto error = render.prepare(reader->sampleRate); error.isNotEmpty())
+				state->fail(error);
+			else if (!render.render(*reader, state->output, state->result.numFrames))
+				state->fail("Rendering channels " + juce::String(firstChannel + 1) + "-" + juce::String(firstChannel + numChannels) + " failed");
+
+			render.release();
+			state->taskFinished();
+		}
+
+		void renderFile(WorkStealingPool& pool, std::shared_ptr<FileState> state, std::shared_ptr<const Settings> settings)
+		{
+			auto& result = state->result;
+			state->start = Clock::now();
+
+			auto reader = createReader(result.input);
+
+			if (reader == nullptr || reader->numChannels == 0)
+			{
+				state->fail("Can't read " + result.input.getFullPathName());
+				state->taskFinished();
+				return;
+			}
+
+			result.numChannels = static_cast<int>(reader->numChannels);
+			result.sampleRate = reader->sampleRate;
+
+			const auto seconds = static_cast<double>(reader->lengthInSamples) / reader->sampleRate;
+			result.split = settings->splitChannels && result.numChannels > 1 && seconds >= settings->splitAboveSeconds;
+
+			//this task always renders the first channel, or all of them when the file isn't split
+			auto render = std::make_unique<ChannelRender>(*settings, 0, result.split ? 1 : result.numChannels);
+
+			if (auto error = render->prepare(reader->sampleRate); error.isNotEmpty())
+			{
+				state->fail(error);
+				state->taskFinished();
+				return;
+			}
+
+			result.numFrames = reader->lengthInSamples + (settings->includeTail ? render->getTailFrames() : 0);
+
+			if (auto error = state->output.open(result.output, *settings, *reader, result.numFrames); error.isNotEmpty())
+			{
+				state->fail(error);
+				state->taskFinished();
+				return;
+			}
+
+			if (result.split && !state->output.isMapped())
+			{
+				//too big for a mapped RIFF file, and the streaming writer takes all channels together
+				result.split = false;
+				render->release();
+				render = std::make_unique<ChannelRender>(*settings, 0, result.numChannels);
+
+				if (auto error = render->prepare(reader->sampleRate); error.isNotEmpty())
+				{
+					state->fail(error);
+					state->taskFinished();
+					return;
+				}
+			}
+
+			if (result.split)
+			{
+				//the other channels are added to the pool, which hands them out before any queued file
+				state->remaining += result.numChannels - 1;
+
+				for (int ch = 1; ch < result.numChannels; ++ch)
+					pool.submit([state, settings, ch] { renderChannels(state, *settings, ch, 1); });
+			}
+
+			if (!render->render(*reader, state->output, result.numFrames))
+				state->fail("Rendering " + result.input.getFullPathName() + " failed");
+
+			render->release();
+			state->taskFinished();
+		}
+	}
+
+	//==============================================================================
+	juce::String configure(AudioPluginAudioProcessor& processor, const Settings& settings)
+	{
+		if (!settings.state.isEmpty())
+			if (!PluginState::read(processor, settings.state.getData(), static_cast<int>(settings.state.getSize())))
+				return "The state isn't one this build can read";
+
+		if (settings.preset >= 0)
+		{
+			if (settings.preset >= processor.getNumPrograms())
+				return "There is no preset " + juce::String(settings.preset);
+
+			//only the parameters, a program change would fade over to the preset on the first block
+			processor.loadPresetParameters(settings.preset);
+		}
+
+		for (auto& parameterID : settings.parameters.getAllKeys())
+		{
+			auto* parameter = processor.apvts.getParameter(parameterID);
+
+			if (parameter == nullptr)
+				return "There is no parameter \"" + parameterID + "\"";
+
+			parameter->setValueNotifyingHost(parameter->convertTo0to1(settings.parameters[parameterID].getFloatValue()));
+		}
+
+		return {};
+	}
+
+	bool hasIndependentChannels(AudioPluginAudioProcessor& processor)
+	{
+		auto& apvts = processor.apvts;
+
+		const auto linked = static_cast<int>(apvts.getRawParameterValue("Stereo Mode")->load()) == Stereo_Linked;
+		const auto dynamic = apvts.getRawParameterValue("Peak Dynamic")->load() > 0.5f
+			&& apvts.getRawParameterValue("Peak Enabled")->load() > 0.5f;
+
+		return linked && !dynamic;
+	}
+
+	void submit(WorkStealingPool& pool, const juce::File& input, const juce::File& output,
+		const Settings& settings, std::function<void(const Result&)> onFinished)
+	{
+		auto state = std::make_shared<FileState>();
+		state->result.input = input;
+		state->result.output = output;
+		state->remaining = 1;
+		state->onFinished = std::move(onFinished);
+
+		auto sharedSettings = std::make_shared<const Settings>(settings);
+		pool.submit([&pool, state, sharedSettings] { renderFile(pool, state, sharedSettings); });
+	}
+}
@@ -0,0 +1,64 @@
+/*
+  ==============================================================================
+
+    Renders one file through its own AudioPluginAudioProcessor. A file is one
+    task on the pool, unless it is long enough to be worth splitting and the
+    chains don't mix channels: then the file's task renders the first
+    channel itself and hands the others out as tasks of their own, each
+    with its own processor and its own reader, all writing straight into
+    the same memory mapped output.
+
+    WAV input is read through a memory mapped reader, FLAC through JUCE's
+    streaming reader, and every render works through the file block by
+    block, so no file is ever held in memory as a whole.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "WorkStealingPool.h"
+
+class AudioPluginAudioProcessor;
+
+namespace RenderJob
+{
+	struct Settings
+	{
+		juce::MemoryBlock state;			//as written by getStateInformation, empty to keep the defaults
+		int preset{ -1 };					//factory preset applied on top of the state, -1 for none
+		juce::StringPairArray parameters;	//plain values by parameter ID, applied last
+
+		int blockSize{ 1024 };
+		bool includeTail{ false };			//append the filters' decay instead of cutting it off at the input's end
+		int bitDepth{ 0 };					//16, 24 or 32, 0 keeps the input's
+		bool floatingPoint{ false };		//32 bit float output, WAV only
+
+		bool splitChannels{ false };		//only when hasIndependentChannels() holds for the configuration
+		double splitAboveSeconds{ 60.0 };	//shorter files are rendered as a whole
+	};
+
+	struct Result
+	{
+		juce::File input, output;
+		bool succeeded{ false };
+		juce::String error;
+		int numChannels{ 0 };
+		double sampleRate{ 0.0 };
+		juce::int64 numFrames{ 0 };
+		bool split{ false };
+		double renderSeconds{ 0.0 };		//wall time from the first task starting to the last one finishing
+	};
+
+	//applies the state, preset and parameters to a freshly created processor. Returns an error, or an empty string
+	juce::String configure(AudioPluginAudioProcessor& processor, const Settings& settings);
+
+	//true when no part of the configured chain mixes channels, so rendering each channel on its own gives
+	//the same result as rendering them together: linked stereo and no dynamic peak, whose detector listens to all of them
+	bool hasIndependentChannels(AudioPluginAudioProcessor& processor);
+
+	//any thread. Submits the file's tasks, onFinished is called once on whichever worker finishes last
+	void submit(WorkStealingPool& pool, const juce::File& input, const juce::File& output,
+		const Settings& settings, std::function<void(const Result&)> onFinished);
+}
@@ -0,0 +1,170 @@
+/*
+  ==============================================================================
+
+    Thread pool for the batch renderer.
+
+  ==============================================================================
+*/
+
+#include "WorkStealingPool.h"
+
+namespace
+{
+	//which worker the calling thread is, -1 for threads outside the pool
+	thread_local int currentWorker = -1;
+	thread_local const WorkStealingPool* currentPool = nullptr;
+}
+
+WorkStealingPool::WorkStealingPool(int numWorkers)
+{
+	if (numWorkers <= 0)
+		numWorkers = juce::jmax(1, juce::SystemStats::getNumCpus());
+
+	for (int i = 0; i < numWorkers; ++i)
+		workers.push_back(std::make_unique<Worker>());
+
+	//only started once every queue exists, a worker may steal straight away
+	for (int i = 0; i < numWorkers; ++i)
+		workers[static_cast<size_t>(i)]->thread = std::thread([this, i] { run(i); });
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+	{
+		const std::lock_guard<std::mutex> sl(sleepLock);
+		stopping = true;
+	}
+
+	wakeUp.notify_all();
+
+	for (auto& worker : workers)
+		worker->thread.join();
+}
+
+void WorkStealingPool::submit(Task task)
+{
+	const auto own = currentPool == this ? currentWorker : -1;
+	const auto index = own >= 0 ? own : static_cast<int>(nextQueue++ % workers.size());
+
+	unfinished.fetch_add(1);
+
+	{
+		auto& worker = *workers[static_cast<size_t>(index)];
+		const std::lock_guard<std::mutex> sl(worker.lock);
+
+		if (own >= 0)
+			worker.added.push_back(std::move(task));
+		else
+			worker.tasks.push_back(std::move(task));
+	}
+
+	{
+		//taken so a worker that just found every queue empty can't miss the wake up
+		const std::lock_guard<std::mutex> sl(sleepLock);
+		queued.fetch_add(1);
+	}
+
+	wakeUp.notify_one();
+}
+
+void WorkStealingPool::waitUntilDone()
+{
+	std::unique_lock<std::mutex> sl(sleepLock);
+	allDone.wait(sl, [this] { return unfinished.load() == 0; });
+}
+
+bool WorkStealingPool::takeAdded(int index, Task& task)
+{
+	const auto numWorkers = static_cast<int>(workers.size());
+
+	//this worker's own first, from the back like its files, then the others' from the front
+	for (int offset = 0; offset < numWorkers; ++offset)
+	{
+		auto& worker = *workers[static_cast<size_t>((index + offset) % numWorkers)];
+		const std::lock_guard<std::mutex> sl(worker.lock);
+
+		if (worker.added.empty())
+			continue;
+
+		if (offset == 0)
+		{
+			task = std::move(worker.added.back());
+			worker.added.pop_back();
+			return true;
+		}
+
+		task = std::move(worker.added.front());
+		worker.added.pop_front();
+		steals.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+bool WorkStealingPool::popOwn(int index, Task& task)
+{
+	auto& worker = *workers[static_cast<size_t>(index)];
+	const std::lock_guard<std::mutex> sl(worker.lock);
+
+	if (worker.tasks.empty())
+		return false;
+
+	task = std::move(worker.tasks.back());
+	worker.tasks.pop_back();
+	return true;
+}
+
+bool WorkStealingPool::steal(int index, Task& task)
+{
+	const auto numWorkers = static_cast<int>(workers.size());
+
+	//starting next door, so thieves spread out over the queues instead of all hitting the first one
+	for (int offset = 1; offset < numWorkers; ++offset)
+	{
+		auto& victim = *workers[static_cast<size_t>((index + offset) % numWorkers)];
+		const std::lock_guard<std::mutex> sl(victim.lock);
+
+		if (victim.tasks.empty())
+			continue;
+
+		task = std::move(victim.tasks.front());
+		victim.tasks.pop_front();
+		steals.fetch_add(1, std::memory_order_relaxed);
+		return true;
+	}
+
+	return false;
+}
+
+void WorkStealingPool::run(int index)
+{
+	currentWorker = index;
+	currentPool = this;
+
+	for (;;)
+	{
+		Task task;
+
+		if (takeAdded(index, task) || popOwn(index, task) || steal(index, task))
+		{
+			queued.fetch_sub(1);
+			task();
+			task = nullptr; //whatever the task holds goes before it counts as finished
+
+			if (unfinished.fetch_sub(1) == 1)
+			{
+				const std::lock_guard<std::mutex> sl(sleepLock);
+				allDone.notify_all();
+			}
+
+			continue;
+		}
+
+		std::unique_lock<std::mutex> sl(sleepLock);
+		wakeUp.wait(sl, [this] { return stopping.load() || queued.load() > 0; });
+
+		if (stopping && queued.load() == 0)
+			return;
+	}
+}
@@ -0,0 +1,79 @@
+/*
+  ==============================================================================
+
+    Thread pool for the batch renderer. Every worker owns a queue of tasks.
+    Tasks from outside are dealt out round robin in the order they come,
+    which Main.cpp sorts by size, smallest first, so every queue holds its
+    biggest files at the back. A worker takes its own work from the back,
+    biggest first, and one that runs dry steals from the front of the
+    others' queues, the small files that fill the gaps at the end.
+
+    Tasks added by a task, the channels of a file that was split, go onto a
+    second queue of the worker that added them. Every worker looks at those
+    before any file, its own first and then everybody else's, so the
+    channels of a long file really run side by side instead of waiting
+    behind the files still queued.
+
+    The queues are guarded by one small lock each. Tasks are whole files or
+    whole channels of a file, seconds of work each, so a lock per pop costs
+    nothing, and workers only ever touch another worker's lock to steal.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+
+class WorkStealingPool
+{
+public:
+	using Task = std::function<void()>;
+
+	//numWorkers threads, 0 for one per logical core
+	explicit WorkStealingPool(int numWorkers);
+	~WorkStealingPool();
+
+	//any thread. From a worker the task goes onto that worker's queue of added tasks and is
+	//taken before any other, from outside the file queues are filled round robin
+	void submit(Task task);
+
+	//blocks until every task, including the ones added by tasks, has run
+	void waitUntilDone();
+
+	int getNumWorkers() const noexcept { return static_cast<int>(workers.size()); }
+
+	//how many tasks were taken from another worker's queues so far
+	juce::int64 getNumSteals() const noexcept { return steals.load(std::memory_order_relaxed); }
+
+private:
+	struct Worker
+	{
+		std::mutex lock;
+		std::deque<Task> tasks;
+		std::deque<Task> added;	//submitted from this worker's tasks, ahead of every file
+		std::thread thread;
+	};
+
+	void run(int index);
+	bool takeAdded(int index, Task& task);
+	bool popOwn(int index, Task& task);
+	bool steal(int index, Task& task);
+
+	std::vector<std::unique_ptr<Worker>> workers;
+
+	std::mutex sleepLock;						//only for sleeping and waking up
+	std::condition_variable wakeUp, allDone;
+	std::atomic<juce::int64> queued{ 0 };		//submitted and not yet taken
+	std::atomic<juce::int64> unfinished{ 0 };	//submitted and not yet finished
+	std::atomic<bool> stopping{ false };
+
+	std::atomic<juce::uint32> nextQueue{ 0 };
+	std::atomic<juce::int64> steals{ 0 };
+
+	JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(WorkStealingPool)
+};
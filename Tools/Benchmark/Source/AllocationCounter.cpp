@@ -0,0 +1,70 @@
+/*
+  ==============================================================================
+
+    Counts every heap allocation made through operator new.
+
+  ==============================================================================
+*/
+
+#include "AllocationCounter.h"
+
+namespace
+{
+	std::atomic<juce::int64> numAllocations{ 0 };
+
+	void* allocate(std::size_t size)
+	{
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		if (auto* p = std::malloc(size > 0 ? size : 1))
+			return p;
+
+		throw std::bad_alloc();
+	}
+
+	void* allocateAligned(std::size_t size, std::align_val_t alignment)
+	{
+		numAllocations.fetch_add(1, std::memory_order_relaxed);
+
+		const auto align = static_cast<std::size_t>(alignment);
+
+	   #if JUCE_WINDOWS
+		if (auto* p = _aligned_malloc(size > 0 ? size : 1, align))
+			return p;
+	   #else
+		if (auto* p = std::aligned_alloc(align, ((size + align - 1) / align) * align))
+			return p;
+	   #endif
+
+		throw std::bad_alloc();
+	}
+
+	void freeAligned(void* p) noexcept
+	{
+	   #if JUCE_WINDOWS
+		_aligned_free(p);
+	   #else
+		std::free(p);
+	   #endif
+	}
+}
+
+juce::int64 AllocationCounter::getCount() noexcept
+{
+	return numAllocations.load(std::memory_order_relaxed);
+}
+
+//==============================================================================
+void* operator new(std::size_t size)									{ return allocate(size); }
+void* operator new[](std::size_t size)									{ return allocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment)		{ return allocateAligned(size, alignment); }
+void* operator new[](std::size_t size, std::align_val_t alignment)		{ return allocateAligned(size, alignment); }
+
+void operator delete(void* p) noexcept									{ std::free(p); }
+void operator delete[](void* p) noexcept								{ std::free(p); }
+void operator delete(void* p, std::size_t) noexcept						{ std::free(p); }
+void operator delete[](void* p, std::size_t) noexcept					{ std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept				{ freeAligned(p); }
+void operator delete[](void* p, std::align_val_t) noexcept				{ freeAligned(p); }
+void operator delete(void* p, std::size_t, std::align_val_t) noexcept	{ freeAligned(p); }
+void operator delete[](void* p, std::size_t, std::align_val_t) noexcept	{ freeAligned(p); }
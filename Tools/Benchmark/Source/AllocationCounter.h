@@ -0,0 +1,19 @@
+/*
+  ==============================================================================
+
+    Counts every heap allocation made through operator new in the benchmark
+    binary. The global operators are replaced in AllocationCounter.cpp, so
+    this covers JUCE's containers and ReferenceCountedObjects as well.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+namespace AllocationCounter
+{
+	//process wide and on every thread, so only meaningful while nothing else is running
+	juce::int64 getCount() noexcept;
+}
@@ -0,0 +1,26 @@
+/*
+  ==============================================================================
+
+    Small helpers for the benchmark's command line.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+//comma separated values for an option, or the fallback if the option wasn't given
+template <typename Type>
+juce::Array<Type> parseList(const juce::ArgumentList& args, juce::StringRef option, const juce::Array<Type>& fallback)
+{
+	if (!args.containsOption(option))
+		return fallback;
+
+	juce::Array<Type> values;
+
+	for (auto& token : juce::StringArray::fromTokens(args.getValueForOption(option), ",", {}))
+		values.add(static_cast<Type>(token.trim().getDoubleValue()));
+
+	return values;
+}
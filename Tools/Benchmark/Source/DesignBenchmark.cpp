@@ -0,0 +1,362 @@
+/*
+  ==============================================================================
+
+    Micro benchmarks for the control path.
+
+  ==============================================================================
+*/
+
+#include "DesignBenchmark.h"
+#include "AllocationCounter.h"
+#include "CommandLine.h"
+#include "OriginalChain.h"
+#include "../../../Source/BiquadEngine.h"
+#include "../../../Source/DesignCache.h"
+#include "../../../Source/CutFilterTables.h"
+#include "../../../Source/EqualizerChain.h"
+#include "../../../Source/TripleBuffer.h"
+
+namespace
+{
+	//==============================================================================
+	struct Measurement
+	{
+		double nsPerCall{ 0.0 };
+		double allocationsPerCall{ 0.0 };
+	};
+
+	constexpr int numRuns = 7;
+	constexpr double runSeconds = 0.02;
+
+	//median of several runs, each long enough that the clock resolution doesn't matter
+	template <typename Operation>
+	Measurement measure(Operation&& operation)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		int iterations = 1;
+
+		for (;;)
+		{
+			const auto start = Clock::now();
+
+			for (int i = 0; i < iterations; ++i)
+				operation(i);
+
+			if (std::chrono::duration<double>(Clock::now() - start).count() >= runSeconds || iterations >= (1 << 24))
+				break;
+
+			iterations *= 2;
+		}
+
+		std::vector<double> runs;
+		juce::int64 allocations = 0;
+
+		for (int run = 0; run < numRuns; ++run)
+		{
+			const auto allocationsBefore = AllocationCounter::getCount();
+			const auto start = Clock::now();
+
+			for (int i = 0; i < iterations; ++i)
+				operation(i);
+
+			const auto end = Clock::now();
+			allocations += AllocationCounter::getCount() - allocationsBefore;
+
+			runs.push_back(std::chrono::duration<double, std::nano>(end - start).count() / iterations);
+		}
+
+		std::sort(runs.begin(), runs.end());
+
+		return { runs[runs.size() / 2], static_cast<double>(allocations) / (static_cast<double>(iterations) * numRuns) };
+	}
+
+	//the frequencies cycle through the audible range so nothing can be hoisted out of the loop
+	constexpr int numFrequencies = 64;
+
+	std::array<float, numFrequencies> makeFrequencies()
+	{
+		std::array<float, numFrequencies> frequencies;
+
+		for (int i = 0; i < numFrequencies; ++i)
+			frequencies[static_cast<size_t>(i)] = juce::mapToLog10(static_cast<float>(i) / (numFrequencies - 1), 20.f, 20000.f);
+
+		return frequencies;
+	}
+
+	const auto frequencies = makeFrequencies();
+
+	float frequencyFor(int i) noexcept { return frequencies[static_cast<size_t>(i & (numFrequencies - 1))]; }
+
+	volatile float sink = 0.f; //keeps the optimiser from dropping results nobody reads
+
+	//==============================================================================
+	class Report
+	{
+	public:
+		void add(const juce::String& operation, const juce::String& path, double sampleRate, int slope, const Measurement& m)
+		{
+			auto* result = new juce::DynamicObject();
+			result->setProperty("operation", operation);
+			result->setProperty("path", path);
+			result->setProperty("sampleRate", sampleRate);
+
+			if (slope > 0)
+				result->setProperty("slopeDbPerOct", slope);
+
+			result->setProperty("nsPerCall", m.nsPerCall);
+			result->setProperty("callsPerSecond", m.nsPerCall > 0.0 ? 1.0e9 / m.nsPerCall : 0.0);
+			result->setProperty("allocationsPerCall", m.allocationsPerCall);
+
+			results.add(juce::var(result));
+			std::cerr << "." << std::flush;
+		}
+
+		juce::Array<juce::var> results;
+	};
+
+	void runCutBenchmarks(Report& report, double sampleRate, Slope slope)
+	{
+		const auto slopeDb = 12 * (slope + 1);
+
+		//design alone
+		report.add("designLowCut", "juce", sampleRate, slopeDb, measure([&](int i)
+		{
+			sink = sink + Original::designLowCut(frequencyFor(i), sampleRate, slope)[0]->coefficients[0];
+		}));
+
+		report.add("designLowCut", "current", sampleRate, slopeDb, measure([&](int i)
+		{
+			std::array<BiquadCoefficients, maxCutSections> sections;
+			makeLowCutCoefficients(sections, sampleRate, frequencyFor(i), slope);
+			sink = sink + sections[0].b0;
+		}));
+
+		//the same frequencies over and over, so after the first round every lookup is a hit
+		{
+			juce::SharedResourcePointer<DesignCache> designCache;
+
+			ChainSettings settings;
+			settings.lowCutSlope = slope;
+
+			report.add("designLowCut", "cached", sampleRate, slopeDb, measure([&](int i)
+			{
+				ChainCoefficients chainCoefficients;
+				chainCoefficients.sampleRate = sampleRate;
+				settings.lowCutFreq = frequencyFor(i);
+
+				designCache->makeLowCutCoefficients(chainCoefficients, settings);
+				sink = sink + chainCoefficients.lowCut[0].b0;
+			}));
+		}
+
+		{
+			const auto table = std::make_shared<const CutFilterTable>(sampleRate);
+
+			report.add("designLowCut", "table", sampleRate, slopeDb, measure([&](int i)
+			{
+				std::array<BiquadCoefficients, maxCutSections> sections;
+				table->makeLowCutCoefficients(sections, frequencyFor(i), slope);
+				sink = sink + sections[0].b0;
+			}));
+
+			report.add("designHighCut", "table", sampleRate, slopeDb, measure([&](int i)
+			{
+				std::array<BiquadCoefficients, maxCutSections> sections;
+				table->makeHighCutCoefficients(sections, frequencyFor(i), slope);
+				sink = sink + sections[0].b0;
+			}));
+		}
+
+		report.add("designHighCut", "juce", sampleRate, slopeDb, measure([&](int i)
+		{
+			sink = sink + Original::designHighCut(frequencyFor(i), sampleRate, slope)[0]->coefficients[0];
+		}));
+
+		report.add("designHighCut", "current", sampleRate, slopeDb, measure([&](int i)
+		{
+			std::array<BiquadCoefficients, maxCutSections> sections;
+			makeHighCutCoefficients(sections, sampleRate, frequencyFor(i), slope);
+			sink = sink + sections[0].b0;
+		}));
+
+		//getting a finished design into the filters: the coefficient copies plus the bypass switching
+		//of updateCutFilter, against broadcasting a whole set into the SIMD engine for a stereo pair
+		{
+			const auto designed = Original::designLowCut(1000.f, sampleRate, slope);
+
+			Original::CutFilter left, right;
+			Original::updateCutFilter(left, designed, slope); //the filters own their coefficient objects from here on
+			Original::updateCutFilter(right, designed, slope);
+
+			report.add("updateCutFilter", "juce", sampleRate, slopeDb, measure([&](int)
+			{
+				Original::updateCutFilter(left, designed, slope);
+				Original::updateCutFilter(right, designed, slope);
+			}));
+		}
+
+		{
+			ChainCoefficients chainCoefficients;
+			chainCoefficients.sampleRate = sampleRate;
+
+			ChainSettings settings;
+			settings.lowCutFreq = 1000.f;
+			settings.highCutFreq = 20000.f;
+			settings.bands[0] = { true, Band_Peak, 750.f, 0.f, 1.f };
+			settings.lowCutSlope = slope;
+
+			makeLowCutCoefficients(chainCoefficients, settings);
+			makeHighCutCoefficients(chainCoefficients, settings);
+			makeBandCoefficients(chainCoefficients, settings, 0);
+
+			BiquadEngine engine;
+			engine.prepare(2, 512, false);
+
+			report.add("updateCutFilter", "current", sampleRate, slopeDb, measure([&](int)
+			{
+				engine.setCoefficients(chainCoefficients);
+			}));
+		}
+
+		//one automated low cut move end to end, design and handover for a stereo chain. This
+		//is the cost per parameter change and so the limit for automation heavy sessions
+		{
+			Original::CutFilter left, right;
+			Original::updateCutFilter(left, Original::designLowCut(1000.f, sampleRate, slope), slope);
+			Original::updateCutFilter(right, Original::designLowCut(1000.f, sampleRate, slope), slope);
+
+			report.add("parameterChange", "juce", sampleRate, slopeDb, measure([&](int i)
+			{
+				const auto designed = Original::designLowCut(frequencyFor(i), sampleRate, slope);
+				Original::updateCutFilter(left, designed, slope);
+				Original::updateCutFilter(right, designed, slope);
+			}));
+		}
+
+		{
+			ChainSettings settings;
+			settings.highCutFreq = 20000.f;
+			settings.bands[0] = { true, Band_Peak, 750.f, 0.f, 1.f };
+			settings.lowCutSlope = slope;
+
+			ChainCoefficients designed;
+			designed.sampleRate = sampleRate;
+			makeHighCutCoefficients(designed, settings);
+			makeBandCoefficients(designed, settings, 0);
+
+			TripleBuffer<ChainCoefficients> handover;
+
+			EqualizerChain chain;
+			chain.prepare(2, 512);
+
+			report.add("parameterChange", "current", sampleRate, slopeDb, measure([&](int i)
+			{
+				settings.lowCutFreq = frequencyFor(i);
+				makeLowCutCoefficients(designed, settings);
+
+				handover.getWriteSlot() = designed;
+				handover.publish();
+
+				if (handover.pull())
+					chain.setCoefficients(handover.getReadSlot());
+			}));
+		}
+	}
+
+	void runPeakBenchmarks(Report& report, double sampleRate)
+	{
+		report.add("designPeak", "juce", sampleRate, 0, measure([&](int i)
+		{
+			sink = sink + juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, frequencyFor(i), 1.f, 2.f)->coefficients[0];
+		}));
+
+		report.add("designPeak", "current", sampleRate, 0, measure([&](int i)
+		{
+			sink = sink + makePeakCoefficients(sampleRate, frequencyFor(i), 1.f, 2.f).b0;
+		}));
+
+		juce::SharedResourcePointer<DesignCache> designCache;
+
+		ChainSettings settings;
+		settings.bands[0] = { true, Band_Peak, 750.f, 6.f, 1.f };
+
+		report.add("designPeak", "cached", sampleRate, 0, measure([&](int i)
+		{
+			ChainCoefficients chainCoefficients;
+			chainCoefficients.sampleRate = sampleRate;
+			settings.bands[0].frequency = frequencyFor(i);
+
+			designCache->makeBandCoefficients(chainCoefficients, settings, 0);
+			sink = sink + chainCoefficients.bands[0].b0;
+		}));
+	}
+
+}
+
+//==============================================================================
+int runDesignBenchmarks(const juce::ArgumentList& args)
+{
+	const auto sampleRates = parseList(args, "--sample-rates", juce::Array<double>{ 44100.0, 48000.0, 96000.0, 192000.0 });
+	const auto slopes = parseList(args, "--slopes", juce::Array<int>{ 12, 24, 36, 48 });
+
+	Report report;
+	juce::SharedResourcePointer<DesignCache> designCache; //kept alive for the whole run, so the counters cover all of it
+
+	for (auto sampleRate : sampleRates)
+	{
+		runPeakBenchmarks(report, sampleRate);
+
+		for (auto slope : slopes)
+			runCutBenchmarks(report, sampleRate, static_cast<Slope>(juce::jlimit(0, 3, slope / 12 - 1)));
+	}
+
+	std::cerr << std::endl;
+
+	auto* root = new juce::DynamicObject();
+	root->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+	root->setProperty("cpu", juce::SystemStats::getCpuModel());
+	root->setProperty("results", report.results);
+
+	const auto cacheStatistics = designCache->getStatistics();
+	auto* cache = new juce::DynamicObject();
+	cache->setProperty("hits", static_cast<juce::int64>(cacheStatistics.hits));
+	cache->setProperty("misses", static_cast<juce::int64>(cacheStatistics.misses));
+	cache->setProperty("evictions", static_cast<juce::int64>(cacheStatistics.evictions));
+	root->setProperty("designCache", juce::var(cache));
+
+	//memory and build time of the cut tables, the first table at a rate is built from scratch
+	juce::Array<juce::var> cutTables;
+
+	for (auto sampleRate : sampleRates)
+	{
+		const CutFilterTable table(sampleRate);
+
+		auto* entry = new juce::DynamicObject();
+		entry->setProperty("sampleRate", sampleRate);
+		entry->setProperty("bytes", static_cast<juce::int64>(table.getSizeInBytes()));
+		entry->setProperty("buildMs", table.getBuildMilliseconds());
+		cutTables.add(juce::var(entry));
+	}
+
+	root->setProperty("cutTables", cutTables);
+
+	const auto json = juce::JSON::toString(juce::var(root));
+
+	if (args.containsOption("--output"))
+	{
+		const auto file = args.getFileForOption("--output");
+
+		if (!file.replaceWithText(json))
+		{
+			std::cerr << "Can't write " << file.getFullPathName() << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		std::cout << json << std::endl;
+	}
+
+	return 0;
+}
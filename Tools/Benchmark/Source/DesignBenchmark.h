@@ -0,0 +1,20 @@
+/*
+  ==============================================================================
+
+    Micro benchmarks for the control path: designing cut and peak
+    coefficients, getting them into the filters and a whole parameter
+    change from design to the audio thread. Every operation is timed for
+    the original JUCE based path the plugin used to run and for the
+    current allocation free one, with the heap allocations per call.
+
+    Benchmark --design [--sample-rates 44100,48000,96000,192000]
+                       [--slopes 12,24,36,48] [--output design.json]
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+
+int runDesignBenchmarks(const juce::ArgumentList& args);
@@ -0,0 +1,535 @@
+/*
+  ==============================================================================
+
+    Headless render benchmark for AudioPluginAudioProcessor. No editor and
+    no audio device: the processor is driven straight through processBlock
+    over a matrix of block sizes, sample rates, cut slopes, oversampling
+    factors, automation densities, peak modes and band counts, and every case
+    is reported as JSON.
+
+    Benchmark [--block-sizes 64,256,1024] [--sample-rates 44100,96000]
+              [--slopes 12,48] [--oversampling 1,2,4] [--automation 0,10,100]
+              [--dynamic 0,1] [--bands 1,8]
+              [--channels 2] [--seconds 10] [--input file.wav]
+              [--output results.json] [--paced] [--rt-check] [--stress 2]
+              [--no-original]
+
+    Benchmark --design runs the control path micro benchmarks instead,
+    see DesignBenchmark.h.
+
+    --automation is in parameter changes per second of audio. The changes
+    go through the parameters like host automation, so they reach the audio
+    thread through the designer thread. Without --paced the render runs
+    faster than real time and the designer sees several changes at once,
+    --paced holds every block back to its real time position instead.
+
+    --dynamic 1 runs the peak band in its dynamic mode, set up so that it
+    keeps moving on the generated input, to compare against the static peak.
+
+    --bands is how many of the bands between the cuts are switched on, the
+    peak band plus that many minus one of the others, cycling through the
+    band types.
+
+    Every case the original plugin could run, no oversampling, a static
+    peak and one band, is rendered a second time through the scalar
+    juce::dsp::ProcessorChain it originally shipped with, see
+    OriginalChain.h, with the same input, block size and automation. Its
+    timings go into the case's "original" object and "speedup" is its
+    ns/sample over the current one. --no-original skips it.
+
+    --rt-check turns on the RealtimeGuard: every allocation, mutex lock or
+    sleep inside processBlock is printed with its stack trace and the run
+    exits with code 2. --stress starts that many threads which keep setting
+    random parameters to random values while the audio is rendered.
+
+  ==============================================================================
+*/
+
+#include <JuceHeader.h>
+#include "../../../Source/PluginProcessor.h"
+#include "CommandLine.h"
+#include "DesignBenchmark.h"
+#include "OriginalChain.h"
+#include "../../../Source/RealtimeGuard.h"
+
+namespace
+{
+	struct Options
+	{
+		juce::Array<int> blockSizes{ 64, 256, 1024 };
+		juce::Array<double> sampleRates{ 44100.0, 96000.0 };
+		juce::Array<int> slopes{ 12, 48 };
+		juce::Array<int> oversamplingFactors{ 1 };
+		juce::Array<double> automationRates{ 0.0, 10.0, 100.0 };
+		juce::Array<int> dynamicModes{ 0 };
+		juce::Array<int> bandCounts{ 1 };
+		int numChannels{ 2 };
+		double seconds{ 10.0 };
+		juce::File input, output;
+		bool paced{ false };
+		bool realtimeCheck{ false };
+		int numStressThreads{ 0 };
+		bool original{ true };
+	};
+
+	struct Case
+	{
+		int blockSize;
+		double sampleRate;
+		int slope;
+		int oversamplingFactor;
+		double automationRate;
+		bool dynamicPeak;
+		int numBands;
+	};
+
+	Options parseOptions(const juce::ArgumentList& args)
+	{
+		Options options;
+
+		options.blockSizes = parseList(args, "--block-sizes", options.blockSizes);
+		options.sampleRates = parseList(args, "--sample-rates", options.sampleRates);
+		options.slopes = parseList(args, "--slopes", options.slopes);
+		options.oversamplingFactors = parseList(args, "--oversampling", options.oversamplingFactors);
+		options.automationRates = parseList(args, "--automation", options.automationRates);
+		options.dynamicModes = parseList(args, "--dynamic", options.dynamicModes);
+		options.bandCounts = parseList(args, "--bands", options.bandCounts);
+
+		if (args.containsOption("--channels"))
+			options.numChannels = juce::jmax(1, args.getValueForOption("--channels").getIntValue());
+
+		if (args.containsOption("--seconds"))
+			options.seconds = juce::jmax(0.1, args.getValueForOption("--seconds").getDoubleValue());
+
+		if (args.containsOption("--input"))
+			options.input = args.getFileForOption("--input");
+
+		if (args.containsOption("--output"))
+			options.output = args.getFileForOption("--output");
+
+		options.paced = args.containsOption("--paced");
+		options.realtimeCheck = args.containsOption("--rt-check");
+		options.original = !args.containsOption("--no-original");
+
+		if (args.containsOption("--stress"))
+			options.numStressThreads = juce::jmax(1, args.getValueForOption("--stress").getIntValue());
+
+		return options;
+	}
+
+	//==============================================================================
+	//loops the input file if there is one, otherwise a slow sine sweep over white noise
+	class SignalSource
+	{
+	public:
+		explicit SignalSource(const juce::AudioBuffer<float>* fileAudio) : file(fileAudio) {}
+
+		void prepare(double rate)
+		{
+			sampleRate = rate;
+			position = 0;
+			phase = 0.0;
+			random.setSeed(1234);
+		}
+
+		void fill(juce::AudioBuffer<float>& buffer)
+		{
+			const auto numSamples = buffer.getNumSamples();
+
+			if (file != nullptr && file->getNumSamples() > 0)
+			{
+				for (int i = 0; i < numSamples; ++i, ++position)
+				{
+					const auto index = static_cast<int>(position % file->getNumSamples());
+
+					for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+						buffer.setSample(ch, i, file->getSample(ch % file->getNumChannels(), index));
+				}
+
+				return;
+			}
+
+			for (int i = 0; i < numSamples; ++i, ++position)
+			{
+				//20 Hz to 20 kHz and back every 20 seconds
+				const auto t = std::fmod(static_cast<double>(position) / sampleRate, 20.0) / 10.0;
+				const auto frequency = juce::mapToLog10(t < 1.0 ? t : 2.0 - t, 20.0, 20000.0);
+				phase += juce::MathConstants<double>::twoPi * frequency / sampleRate;
+
+				const auto tone = 0.25f * static_cast<float>(std::sin(phase));
+
+				for (int ch = 0; ch < buffer.getNumChannels(); ++ch)
+					buffer.setSample(ch, i, tone + 0.05f * (random.nextFloat() * 2.f - 1.f));
+			}
+
+			phase = std::fmod(phase, juce::MathConstants<double>::twoPi);
+		}
+
+	private:
+		const juce::AudioBuffer<float>* file;
+		double sampleRate{ 44100.0 }, phase{ 0.0 };
+		juce::int64 position{ 0 };
+		juce::Random random;
+	};
+
+	//==============================================================================
+	//sets random parameters to random values from its own thread for as long as it lives, like a
+	//control surface, a script and the host's automation all at once
+	class ParameterStress
+	{
+	public:
+		ParameterStress(juce::AudioProcessor& processor, int numThreads)
+		{
+			for (int i = 0; i < numThreads; ++i)
+			{
+				threads.emplace_back([this, &processor, seed = 100 + i]
+				{
+					juce::Random random(seed);
+					const auto& parameters = processor.getParameters();
+
+					while (!stop.load(std::memory_order_relaxed))
+					{
+						auto* parameter = parameters[random.nextInt(parameters.size())];
+						parameter->beginChangeGesture();
+						parameter->setValueNotifyingHost(random.nextFloat());
+						parameter->endChangeGesture();
+					}
+				});
+			}
+		}
+
+		~ParameterStress()
+		{
+			stop = true;
+
+			for (auto& thread : threads)
+				thread.join();
+		}
+
+	private:
+		std::atomic<bool> stop{ false };
+		std::vector<std::thread> threads;
+	};
+
+	juce::int64 reportViolations(const Case& c)
+	{
+		const auto violations = RealtimeGuard::takeViolations();
+
+		for (auto& violation : violations)
+		{
+			std::cerr << std::endl << "Real-time violation in processBlock (" << violation.what << ") at "
+				<< c.sampleRate << " Hz, " << c.blockSize << " samples:" << std::endl
+				<< violation.stackTrace;
+		}
+
+		return static_cast<juce::int64>(violations.size());
+	}
+
+	//==============================================================================
+	void setParameter(juce::AudioProcessorValueTreeState& apvts, const juce::String& parameterID, float plainValue)
+	{
+		auto* parameter = apvts.getParameter(parameterID);
+		jassert(parameter != nullptr);
+
+		parameter->setValueNotifyingHost(parameter->convertTo0to1(plainValue));
+	}
+
+	double percentile(const std::vector<double>& sorted, double fraction)
+	{
+		if (sorted.empty())
+			return 0.0;
+
+		const auto index = juce::jlimit<size_t>(0, sorted.size() - 1, static_cast<size_t>(fraction * static_cast<double>(sorted.size())));
+		return sorted[index];
+	}
+
+	struct Timing
+	{
+		int numBlocks{ 0 };
+		double totalNanos{ 0.0 };
+		std::vector<double> blockNanos; //sorted
+	};
+
+	//the same input, warm up, pacing and automation for every path that is timed. render(buffer) processes
+	//one block, automate(frequency, gainInDecibels) moves the peak band before the block it lands in
+	template <typename Render, typename Automate>
+	Timing timeRender(const Case& c, const Options& options, const juce::AudioBuffer<float>* fileAudio, Render&& render, Automate&& automate)
+	{
+		using Clock = std::chrono::steady_clock;
+
+		juce::AudioBuffer<float> buffer(options.numChannels, c.blockSize);
+
+		SignalSource source(fileAudio);
+		source.prepare(c.sampleRate);
+
+		//half a second to settle caches and branch predictors before anything is timed
+		for (int done = 0; done < static_cast<int>(c.sampleRate * 0.5); done += c.blockSize)
+		{
+			source.fill(buffer);
+			render(buffer);
+		}
+
+		Timing timing;
+		timing.numBlocks = juce::jmax(1, static_cast<int>(options.seconds * c.sampleRate / c.blockSize));
+		timing.blockNanos.reserve(static_cast<size_t>(timing.numBlocks));
+
+		const auto samplesPerChange = c.automationRate > 0.0 ? c.sampleRate / c.automationRate : 0.0;
+
+		juce::Random automation(4321);
+		double nextChange = samplesPerChange;
+
+		const auto renderStart = Clock::now();
+
+		for (int block = 0; block < timing.numBlocks; ++block)
+		{
+			const auto blockStart = static_cast<double>(block) * c.blockSize;
+
+			if (options.paced)
+			{
+				const auto due = renderStart + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(blockStart / c.sampleRate));
+
+				while (Clock::now() < due)
+					juce::Thread::yield();
+			}
+
+			source.fill(buffer);
+
+			while (samplesPerChange > 0.0 && nextChange < blockStart + c.blockSize)
+			{
+				const auto frequency = juce::mapToLog10(automation.nextFloat(), 20.f, 20000.f);
+				automate(frequency, automation.nextFloat() * 48.f - 24.f);
+				nextChange += samplesPerChange;
+			}
+
+			const auto start = Clock::now();
+			render(buffer);
+			const auto end = Clock::now();
+
+			const auto nanos = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+			timing.blockNanos.push_back(nanos);
+			timing.totalNanos += nanos;
+		}
+
+		std::sort(timing.blockNanos.begin(), timing.blockNanos.end());
+
+		return timing;
+	}
+
+	double getNanosPerSample(const Case& c, const Timing& timing)
+	{
+		return timing.totalNanos / (static_cast<double>(timing.numBlocks) * c.blockSize);
+	}
+
+	void addTiming(juce::DynamicObject& result, const Case& c, const Timing& timing)
+	{
+		const auto numSamples = static_cast<double>(timing.numBlocks) * c.blockSize;
+		const auto audioNanos = numSamples / c.sampleRate * 1.0e9;
+
+		result.setProperty("blocks", timing.numBlocks);
+		result.setProperty("nsPerSample", getNanosPerSample(c, timing));
+		result.setProperty("realtimeFactor", timing.totalNanos > 0.0 ? audioNanos / timing.totalNanos : 0.0);
+		result.setProperty("blockP50Us", percentile(timing.blockNanos, 0.5) * 1.0e-3);
+		result.setProperty("blockP99Us", percentile(timing.blockNanos, 0.99) * 1.0e-3);
+		result.setProperty("blockMaxUs", timing.blockNanos.back() * 1.0e-3);
+	}
+
+	//the original chain only had the cuts and one static peak, so only those cases have a baseline
+	bool hasOriginal(const Case& c)
+	{
+		return c.oversamplingFactor <= 1 && !c.dynamicPeak && c.numBands <= 1;
+	}
+
+	//the same case through the scalar ProcessorChain the plugin originally shipped with
+	Timing runOriginal(const Case& c, const Options& options, const juce::AudioBuffer<float>* fileAudio)
+	{
+		ChainSettings chainSettings;
+		chainSettings.lowCutFreq = 80.f;
+		chainSettings.highCutFreq = 12000.f;
+		chainSettings.lowCutSlope = static_cast<Slope>(juce::jlimit(0, 3, c.slope / 12 - 1));
+		chainSettings.highCutSlope = chainSettings.lowCutSlope;
+		chainSettings.bands[0].enabled = true;
+		chainSettings.bands[0].frequency = 1000.f;
+		chainSettings.bands[0].gainInDecibels = 6.f;
+
+		Original::Processor original;
+		original.prepare(c.sampleRate, c.blockSize, options.numChannels);
+
+		return timeRender(c, options, fileAudio,
+			[&](juce::AudioBuffer<float>& buffer) { original.process(buffer, chainSettings); },
+			[&](float frequency, float gainInDecibels)
+			{
+				chainSettings.bands[0].frequency = frequency;
+				chainSettings.bands[0].gainInDecibels = gainInDecibels;
+			});
+	}
+
+	juce::var runCase(const Case& c, const Options& options, const juce::AudioBuffer<float>* fileAudio, juce::int64& numViolations)
+	{
+		AudioPluginAudioProcessor processor;
+
+		//all bands doing something, so no case measures a chain that happens to be close to flat
+		setParameter(processor.apvts, "LowCut Freq", 80.f);
+		setParameter(processor.apvts, "HighCut Freq", 12000.f);
+		setParameter(processor.apvts, "Peak Freq", 1000.f);
+		setParameter(processor.apvts, "Peak Gain", 6.f);
+		setParameter(processor.apvts, "LowCut Slope", static_cast<float>(juce::jlimit(0, 3, c.slope / 12 - 1)));
+		setParameter(processor.apvts, "HighCut Slope", static_cast<float>(juce::jlimit(0, 3, c.slope / 12 - 1)));
+		setParameter(processor.apvts, "Oversampling", c.oversamplingFactor >= 4 ? 2.f : (c.oversamplingFactor == 2 ? 1.f : 0.f));
+		setParameter(processor.apvts, "Peak Dynamic", c.dynamicPeak ? 1.f : 0.f);
+		setParameter(processor.apvts, "Peak Threshold", -40.f); //low enough that the band is always working
+		setParameter(processor.apvts, "Peak Attack", 1.f);
+		setParameter(processor.apvts, "Peak Release", 20.f);
+
+		for (int band = 1; band < juce::jlimit(1, maxBands, c.numBands); ++band)
+		{
+			setParameter(processor.apvts, getBandParameterID(band, "Enabled"), 1.f);
+			setParameter(processor.apvts, getBandParameterID(band, "Type"), static_cast<float>(band % (Band_BandPass + 1)));
+			setParameter(processor.apvts, getBandParameterID(band, "Gain"), band % 2 == 0 ? 3.f : -3.f);
+		}
+
+		processor.setPlayConfigDetails(options.numChannels, options.numChannels, c.sampleRate, c.blockSize);
+		processor.prepareToPlay(c.sampleRate, c.blockSize);
+
+		juce::MidiBuffer midi;
+
+		std::unique_ptr<ParameterStress> stress;
+
+		if (options.numStressThreads > 0)
+			stress = std::make_unique<ParameterStress>(processor, options.numStressThreads);
+
+		const auto timing = timeRender(c, options, fileAudio,
+			[&](juce::AudioBuffer<float>& buffer) { processor.processBlock(buffer, midi); },
+			[&](float frequency, float gainInDecibels)
+			{
+				setParameter(processor.apvts, "Peak Freq", frequency);
+				setParameter(processor.apvts, "Peak Gain", gainInDecibels);
+			});
+
+		stress.reset();
+		processor.releaseResources();
+
+		const auto caseViolations = options.realtimeCheck ? reportViolations(c) : 0;
+		numViolations += caseViolations;
+
+		auto* result = new juce::DynamicObject();
+		result->setProperty("blockSize", c.blockSize);
+		result->setProperty("sampleRate", c.sampleRate);
+		result->setProperty("slopeDbPerOct", c.slope);
+		result->setProperty("oversampling", c.oversamplingFactor);
+		result->setProperty("automationPerSecond", c.automationRate);
+		result->setProperty("dynamicPeak", c.dynamicPeak);
+		result->setProperty("bands", c.numBands);
+		result->setProperty("channels", options.numChannels);
+		addTiming(*result, c, timing);
+
+		if (options.realtimeCheck)
+			result->setProperty("rtViolations", caseViolations);
+
+		if (options.original && hasOriginal(c))
+		{
+			//rendered after the current path, so the parameter stress threads are gone by then
+			const auto originalTiming = runOriginal(c, options, fileAudio);
+
+			auto* original = new juce::DynamicObject();
+			addTiming(*original, c, originalTiming);
+
+			result->setProperty("original", juce::var(original));
+			result->setProperty("speedup", timing.totalNanos > 0.0 ? getNanosPerSample(c, originalTiming) / getNanosPerSample(c, timing) : 0.0);
+		}
+
+		return juce::var(result);
+	}
+}
+
+//==============================================================================
+int main (int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser; //the processor owns timers, they need a message manager to exist
+
+	const juce::ArgumentList args(argc, argv);
+
+	if (args.containsOption("--design"))
+		return runDesignBenchmarks(args);
+	const auto options = parseOptions(args);
+
+	std::unique_ptr<juce::AudioBuffer<float>> fileAudio;
+
+	if (options.input != juce::File())
+	{
+		juce::AudioFormatManager formats;
+		formats.registerBasicFormats();
+
+		std::unique_ptr<juce::AudioFormatReader> reader(options.input.existsAsFile() ? formats.createReaderFor(options.input) : nullptr);
+
+		if (!options.input.existsAsFile() || reader == nullptr)
+		{
+			std::cerr << "Can't read " << options.input.getFullPathName() << std::endl;
+			return 1;
+		}
+
+		fileAudio = std::make_unique<juce::AudioBuffer<float>>(static_cast<int>(reader->numChannels), static_cast<int>(reader->lengthInSamples));
+		reader->read(fileAudio.get(), 0, static_cast<int>(reader->lengthInSamples), 0, true, true);
+	}
+
+	if (options.realtimeCheck)
+	{
+		if (!RealtimeGuard::isAvailable())
+		{
+			std::cerr << "--rt-check needs a build with EQ_REALTIME_GUARD=1 on Linux" << std::endl;
+			return 1;
+		}
+
+		RealtimeGuard::setEnabled(true);
+	}
+
+	juce::Array<juce::var> results;
+	juce::int64 numViolations = 0;
+
+	for (auto sampleRate : options.sampleRates)
+		for (auto blockSize : options.blockSizes)
+			for (auto slope : options.slopes)
+				for (auto factor : options.oversamplingFactors)
+					for (auto automationRate : options.automationRates)
+						for (auto dynamicMode : options.dynamicModes)
+							for (auto numBands : options.bandCounts)
+							{
+								const Case c{ blockSize, sampleRate, slope, factor, automationRate, dynamicMode != 0, numBands };
+								results.add(runCase(c, options, fileAudio.get(), numViolations));
+
+								std::cerr << "." << std::flush;
+							}
+
+	std::cerr << std::endl;
+
+	auto* report = new juce::DynamicObject();
+	report->setProperty("plugin", JucePlugin_Name);
+	report->setProperty("juceVersion", juce::SystemStats::getJUCEVersion());
+	report->setProperty("cpu", juce::SystemStats::getCpuModel());
+	report->setProperty("input", options.input.existsAsFile() ? options.input.getFullPathName() : juce::String("generated"));
+	report->setProperty("paced", options.paced);
+	report->setProperty("stressThreads", options.numStressThreads);
+	report->setProperty("results", results);
+
+	const auto json = juce::JSON::toString(juce::var(report));
+
+	if (options.output != juce::File())
+	{
+		if (!options.output.replaceWithText(json))
+		{
+			std::cerr << "Can't write " << options.output.getFullPathName() << std::endl;
+			return 1;
+		}
+	}
+	else
+	{
+		std::cout << json << std::endl;
+	}
+
+	if (numViolations > 0)
+	{
+		std::cerr << numViolations << " real-time violations" << std::endl;
+		return 2;
+	}
+
+	return 0;
+}
@@ -0,0 +1,128 @@
+/*
+  ==============================================================================
+
+    The DSP path as the plugin originally shipped it, kept here as the
+    baseline both benchmarks measure against: one juce::dsp::ProcessorChain
+    of scalar IIR filters per channel (low cut, peak, high cut), with every
+    coefficient designed through FilterDesign and copied into the filters
+    at the start of every block.
+
+  ==============================================================================
+*/
+
+#pragma once
+
+#include <JuceHeader.h>
+#include "../../../Source/ChainSettings.h"
+
+namespace Original
+{
+	using Filter = juce::dsp::IIR::Filter<float>;
+	using CutFilter = juce::dsp::ProcessorChain<Filter, Filter, Filter, Filter>;
+	using MonoChain = juce::dsp::ProcessorChain<CutFilter, Filter, CutFilter>;
+	using Coefficients = Filter::CoefficientsPtr;
+	using CutCoefficients = juce::ReferenceCountedArray<juce::dsp::IIR::Coefficients<float>>;
+
+	enum ChainPosition
+	{
+		LowCut,
+		Peak,
+		HighCut
+	};
+
+	inline void updateCoefficients(Coefficients& old, const Coefficients& replacements)
+	{
+		*old = *replacements;
+	}
+
+	template <int index>
+	void update(CutFilter& chain, const CutCoefficients& coefficients)
+	{
+		updateCoefficients(chain.template get<index>().coefficients, coefficients[index]);
+		chain.template setBypassed<index>(false);
+	}
+
+	inline void updateCutFilter(CutFilter& chain, const CutCoefficients& cutCoefficients, Slope slope)
+	{
+		chain.setBypassed<0>(true);
+		chain.setBypassed<1>(true);
+		chain.setBypassed<2>(true);
+		chain.setBypassed<3>(true);
+
+		switch (slope)
+		{
+			case Slope_48: update<3>(chain, cutCoefficients); JUCE_FALLTHROUGH
+			case Slope_36: update<2>(chain, cutCoefficients); JUCE_FALLTHROUGH
+			case Slope_24: update<1>(chain, cutCoefficients); JUCE_FALLTHROUGH
+			case Slope_12: update<0>(chain, cutCoefficients);
+		}
+	}
+
+	inline CutCoefficients designLowCut(float frequency, double sampleRate, Slope slope)
+	{
+		return juce::dsp::FilterDesign<float>::designIIRHighpassHighOrderButterworthMethod(frequency, sampleRate, 2 * (slope + 1));
+	}
+
+	inline CutCoefficients designHighCut(float frequency, double sampleRate, Slope slope)
+	{
+		return juce::dsp::FilterDesign<float>::designIIRLowpassHighOrderButterworthMethod(frequency, sampleRate, 2 * (slope + 1));
+	}
+
+	inline Coefficients designPeak(const BandSettings& band, double sampleRate)
+	{
+		return juce::dsp::IIR::Coefficients<float>::makePeakFilter(sampleRate, band.frequency, band.quality,
+			juce::Decibels::decibelsToGain(band.gainInDecibels));
+	}
+
+	//the original processBlock: only the cuts and the first band, which was the one peak filter
+	class Processor
+	{
+	public:
+		void prepare(double newSampleRate, int maximumBlockSize, int numChannels)
+		{
+			sampleRate = newSampleRate;
+			chains.clear();
+
+			juce::dsp::ProcessSpec spec;
+			spec.maximumBlockSize = static_cast<juce::uint32>(maximumBlockSize);
+			spec.numChannels = 1;
+			spec.sampleRate = sampleRate;
+
+			for (int ch = 0; ch < numChannels; ++ch)
+			{
+				chains.push_back(std::make_unique<MonoChain>());
+				chains.back()->prepare(spec);
+			}
+		}
+
+		void process(juce::AudioBuffer<float>& buffer, const ChainSettings& chainSettings)
+		{
+			juce::ScopedNoDenormals noDenormals;
+
+			//redesigned every block whether anything moved or not, like the original did
+			const auto lowCut = designLowCut(chainSettings.lowCutFreq, sampleRate, chainSettings.lowCutSlope);
+			const auto highCut = designHighCut(chainSettings.highCutFreq, sampleRate, chainSettings.highCutSlope);
+			const auto peak = designPeak(chainSettings.bands[0], sampleRate);
+
+			for (auto& chain : chains)
+			{
+				updateCutFilter(chain->get<LowCut>(), lowCut, chainSettings.lowCutSlope);
+				updateCoefficients(chain->get<Peak>().coefficients, peak);
+				updateCutFilter(chain->get<HighCut>(), highCut, chainSettings.highCutSlope);
+			}
+
+			juce::dsp::AudioBlock<float> block(buffer);
+
+			for (size_t ch = 0; ch < chains.size() && ch < block.getNumChannels(); ++ch)
+			{
+				auto channelBlock = block.getSingleChannelBlock(ch);
+				juce::dsp::ProcessContextReplacing<float> context(channelBlock);
+				chains[ch]->process(context);
+			}
+		}
+
+	private:
+		std::vector<std::unique_ptr<MonoChain>> chains; //one per channel, the filters hold their state
+		double sampleRate{ 44100.0 };
+	};
+}